@@ -1,21 +1,59 @@
 /* v2x-sim-reliable-final.cc
  *
  * Reliable & Real-time V2X simulation for ns-3.38
- * - Pre-populates ARP cache (no ARP delay, Node 0 sends reliably)
- * - Avoids duplicate QueueDisc install
- * - PCAP, FlowMonitor, ASCII traces, queue traces
+ * - Pre-populates ARP cache (no ARP delay, Node 0 sends reliably), per vehicle
+ *   or one shared neighbor table for all nodes (--arpMode=shared)
+ * - Replaces the default QueueDisc instead of installing a second one
+ * - PCAP, FlowMonitor, binary PHY trace (ASCII trace with --asciiTrace), sampled
+ *   queue statistics (per-packet queue events with --logLevel=2)
+ * - Selective PCAP: node filter, snaplen, 1-in-N sampling, single pcapng file
+ * - Buffered, sampled event log instead of per-packet console output
+ * - Stamped-payload PDR / latency percentile / age-of-information metrics
+ * - Memory-mapped columnar per-flow / per-node results instead of FlowMonitor XML
+ * - Bulk topology builder (line, grid, highway, manhattan)
+ * - Optional spatially-indexed spectrum channel (--channelModel=grid)
+ * - RSU beacon / vehicle reaction applications (--trafficMode=beacon)
+ * - V2V geo-broadcast with contention-based relaying and a duplicate ring (--v2vInterval)
+ * - Online per-RSU PDR / latency / throughput / CBR windows, appended as the run goes
+ * - Hot callbacks templated on a compile-time ScenarioTraits profile
+ *   (-DV2X_THROUGHPUT_BUILD compiles out event log, metrics and PHY trace)
+ * - Per-vehicle or batched (timing wheel) send scheduling
+ * - RunScenario() entry point and a multi-process parameter sweep (--sweep)
+ * - Distributed MPI mode with one spatial strip of vehicles per rank
+ * - Multiple RSUs with timer-driven nearest-RSU association and handover
+ * - Streamed SUMO FCD / ns-2 mobility traces (--mobilityTrace)
+ * - Lazily evaluated per-timestamp position cache for channel/association
+ * - Tabulated LogDistance path loss with a batch path (--lossModel=table)
+ * - 802.11p OCB with a control channel and service channels (--wifiMode=ocb)
+ * - C-V2X sidelink Mode 4 (SPS) as an alternative access layer (--accessLayer)
+ * - Selectable queue disc, incl. a beacon/DENM/bulk priority qdisc (--queueDisc)
+ * - ETSI DCC adapting send interval, TX power and rate to channel load (--dcc)
+ * - Sends copy shared, immutable payload templates (no per-send Buffer)
+ * - Per-vehicle state (index, channel, destination, socket, app) in one SoA table
+ * - Binary post-setup snapshot for warm starts (--snapshotSave / --snapshotLoad)
+ * - Wall-clock phase, event-rate, scheduler-depth and peak-RSS profile (--profile)
+ * - Fixed benchmark matrix: size x beacon rate x tracing subsystems (--benchmark)
+ * - Real-time emulation with hard-limit pacing, lag histogram, missed deadlines
+ *   and an optional TAP gateway for RSU 0's DATA (--realtime, --tapDevice)
  *
  * Build:
  *   ./ns3 build scratch/v2x-sim-reliable-final.cc
  *
  * Run example:
  *   ./ns3 run scratch/v2x-sim-reliable-final.cc -- --nVehicles=2 --simTime=12
+ *   ./ns3 run scratch/v2x-sim-reliable-final.cc -- --sweep --sweepVehicles=10,100 \
+ *       --sweepRuns=1,2,3 --sweepJobs=8
+ *   ./ns3 run scratch/v2x-sim-reliable-final.cc -- --benchmark --simTime=5 \
+ *       --benchmarkMaxVehicles=1000
+ *   mpirun -np 4 ./ns3-dev-v2x-sim-reliable-final --distributed --nVehicles=50000
  */
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/mobility-module.h"
 #include "ns3/wifi-module.h"
+#include "ns3/spectrum-module.h"
+#include "ns3/propagation-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/flow-monitor-module.h"
@@ -24,7 +62,47 @@
 #include "ns3/trace-helper.h"
 #include "ns3/arp-cache.h"
 #include "ns3/ipv4-l3-protocol.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/wave-module.h"
 
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+
+#include <mpi.h>
+#endif
+
+#include "v2x-access-layer.h"
+#include "v2x-association.h"
+#include "v2x-beacon-apps.h"
+#include "v2x-benchmark.h"
+#include "v2x-columnar.h"
+#include "v2x-dcc.h"
+#include "v2x-distributed.h"
+#include "v2x-event-log.h"
+#include "v2x-geobroadcast.h"
+#include "v2x-grid-spectrum-channel.h"
+#include "v2x-loss-table.h"
+#include "v2x-metrics.h"
+#include "v2x-neighbor-table.h"
+#include "v2x-ocb.h"
+#include "v2x-online-stats.h"
+#include "v2x-payload.h"
+#include "v2x-phy-trace.h"
+#include "v2x-position-store.h"
+#include "v2x-profiler.h"
+#include "v2x-queue-disc.h"
+#include "v2x-queue-stats.h"
+#include "v2x-realtime.h"
+#include "v2x-scenario.h"
+#include "v2x-send-scheduler.h"
+#include "v2x-snapshot.h"
+#include "v2x-sweep.h"
+#include "v2x-topology.h"
+#include "v2x-trace-mobility.h"
+#include "v2x-traits.h"
+#include "v2x-vehicle-table.h"
+
+#include <chrono>
 #include <fstream>
 #include <vector>
 
@@ -32,230 +110,1293 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("V2XSimReliableFinal");
 
-// --- Callbacks for sockets
-void ReceivePacket(Ptr<Socket> socket)
+// --- Event log, PHY trace and run counters shared by the hot callbacks
+static V2xEventLog g_eventLog;
+static V2xPhyTrace g_phyTrace;
+static V2xMetricsCollector g_metrics;
+static V2xCallbackBudget g_rxBudget; //!< ReceivePacket wall time, --realtime only
+
+static struct
 {
+    uint64_t txPackets; //!< vehicle packets, the PDR denominator
+    uint64_t rxPackets;
+    uint64_t rxBytes;
+    uint64_t beaconPackets; //!< RSU beacons, kept out of txPackets
+} g_counters;
+
+// --- Per-RSU counters, indexed by RSU (windowed by V2xOnlineStats)
+static std::vector<V2xRsuCounters> g_rsuCounters;
+
+// --- Hot callbacks, instantiated for the build's V2xScenarioTraits: a
+//     compiled-out subsystem leaves no test behind, a compiled-in one keeps
+//     its runtime switch
+
+// --- Callbacks for sockets (RSU sockets are bound to their RSU index)
+template <typename Traits>
+void ReceivePacket(uint32_t rsuIdx, Ptr<Socket> socket)
+{
+    // hot path: counters, one clock read, no allocation beyond the socket's own
+    V2xCallbackBudget::Clock::time_point start;
+    if constexpr (Traits::CALLBACK_TIMING)
+    {
+        if (g_rxBudget.IsEnabled())
+        {
+            start = V2xCallbackBudget::Clock::now();
+        }
+    }
+    const int64_t now = Simulator::Now().GetNanoSeconds();
+    V2xRsuCounters& counters = g_rsuCounters[rsuIdx];
     Ptr<Packet> packet;
     Address from;
     while ((packet = socket->RecvFrom(from)))
     {
-        InetSocketAddress addr = InetSocketAddress::ConvertFrom(from);
-        std::cout << Simulator::Now().GetSeconds() << "s: RSU received "
-                  << packet->GetSize() << " bytes from " << addr.GetIpv4()
-                  << std::endl;
+        const uint32_t size = packet->GetSize();
+        ++g_counters.rxPackets;
+        g_counters.rxBytes += size;
+        ++counters.rxPackets;
+        counters.rxBytes += size;
+        if constexpr (Traits::METRICS)
+        {
+            if (g_metrics.IsEnabled())
+            {
+                const double latencyNs = g_metrics.OnReceive(packet, now);
+                if (latencyNs >= 0)
+                {
+                    ++counters.latencyCount;
+                    counters.latencySumNs += latencyNs;
+                }
+            }
+        }
+        if constexpr (Traits::EVENT_LOG)
+        {
+            if (g_eventLog.ShouldLog(V2xEventLog::LEVEL_APP, V2xEventLog::EVENT_RX))
+            {
+                InetSocketAddress addr = InetSocketAddress::ConvertFrom(from);
+                g_eventLog.Record(now,
+                                  V2xEventLog::EVENT_RX,
+                                  socket->GetNode()->GetId(),
+                                  size,
+                                  addr.GetIpv4().Get(),
+                                  addr.GetPort());
+            }
+        }
+    }
+    if constexpr (Traits::CALLBACK_TIMING)
+    {
+        if (g_rxBudget.IsEnabled())
+        {
+            g_rxBudget.Record(start);
+        }
     }
 }
 
+template <typename Traits>
 void SendPacket(Ptr<Socket> socket, Ipv4Address dst, uint16_t port, uint32_t vehId)
 {
-    Ptr<Packet> packet = Create<Packet>(100); // payload
+    Ptr<Packet> packet;
+    if constexpr (Traits::METRICS)
+    {
+        if (g_metrics.IsEnabled())
+        {
+            packet = V2xPayloads().Get(100 - V2xStampHeader::SIZE); // payload, stamp included
+            g_metrics.Stamp(packet, vehId - 1, Simulator::Now().GetNanoSeconds());
+        }
+    }
+    if (!packet)
+    {
+        packet = V2xPayloads().Get(100); // payload
+    }
     socket->SendTo(packet, 0, InetSocketAddress(dst, port));
-    std::cout << Simulator::Now().GetSeconds() << "s: Vehicle " << vehId
-              << " sent packet to RSU " << dst << ":" << port << std::endl;
+    ++g_counters.txPackets;
+    if constexpr (Traits::EVENT_LOG)
+    {
+        if (g_eventLog.ShouldLog(V2xEventLog::LEVEL_APP, V2xEventLog::EVENT_TX))
+        {
+            g_eventLog.Record(Simulator::Now().GetNanoSeconds(),
+                              V2xEventLog::EVENT_TX,
+                              socket->GetNode()->GetId(),
+                              packet->GetSize(),
+                              dst.Get(),
+                              port);
+        }
+    }
+}
+
+// --- Event log record of an application "Tx" (context is the sending node)
+template <typename Traits>
+void LogAppTx(Ptr<const Packet> packet, const Address& to)
+{
+    if constexpr (Traits::EVENT_LOG)
+    {
+        if (g_eventLog.ShouldLog(V2xEventLog::LEVEL_APP, V2xEventLog::EVENT_TX))
+        {
+            InetSocketAddress addr = InetSocketAddress::ConvertFrom(to);
+            g_eventLog.Record(Simulator::Now().GetNanoSeconds(),
+                              V2xEventLog::EVENT_TX,
+                              Simulator::GetContext(),
+                              packet->GetSize(),
+                              addr.GetIpv4().Get(),
+                              addr.GetPort());
+        }
+    }
+}
+
+// --- Application "Tx" trace sink of vehicle applications
+template <typename Traits>
+void AppTxTrace(Ptr<const Packet> packet, const Address& to)
+{
+    ++g_counters.txPackets;
+    if constexpr (Traits::METRICS)
+    {
+        if (g_metrics.IsEnabled())
+        {
+            g_metrics.OnSent(packet);
+        }
+    }
+    LogAppTx<Traits>(packet, to);
 }
 
-// --- Queue trace callbacks
-void QueueEnqueueCallback(Ptr<const QueueDiscItem> item)
+// --- RSU beacon "Tx" sink: beacons are not part of the vehicle PDR
+template <typename Traits>
+void BeaconTxTrace(Ptr<const Packet> packet, const Address& to)
 {
-    std::cout << Simulator::Now().GetSeconds() << "s: Queue Enqueue (pkt size="
-              << item->GetPacket()->GetSize() << ")\n";
+    ++g_counters.beaconPackets;
+    LogAppTx<Traits>(packet, to);
 }
-void QueueDequeueCallback(Ptr<const QueueDiscItem> item)
+
+// --- Vehicle client "Tx" sink (probe or DATA): also counts it against the vehicle's RSU
+template <typename Traits>
+void VehicleTxTrace(const V2xVehicleTable* vt,
+                    uint32_t i,
+                    Ptr<const Packet> packet,
+                    const Address& to)
 {
-    std::cout << Simulator::Now().GetSeconds() << "s: Queue Dequeue (pkt size="
-              << item->GetPacket()->GetSize() << ")\n";
+    ++g_rsuCounters[vt->GetRsu(i)].txPackets;
+    AppTxTrace<Traits>(packet, to);
 }
-void QueueDropCallback(Ptr<const QueueDiscItem> item)
+
+// --- Queue trace callbacks (context is the node id), debug mode of V2xQueueStats;
+//     only connected when Traits::QUEUE_EVENTS
+template <V2xEventLog::Event Event>
+void QueueEventCallback(Ptr<const QueueDiscItem> item)
 {
-    std::cout << Simulator::Now().GetSeconds() << "s: Queue Drop (pkt size="
-              << item->GetPacket()->GetSize() << ")\n";
+    if (g_eventLog.ShouldLog(V2xEventLog::LEVEL_QUEUE, Event))
+    {
+        g_eventLog.Record(Simulator::Now().GetNanoSeconds(),
+                          Event,
+                          Simulator::GetContext(),
+                          item->GetPacket()->GetSize());
+    }
 }
 
-int main(int argc, char *argv[])
+// --- Columnar results: one "flows" row per FlowMonitor flow, one "nodes"
+//     row per local vehicle and RSU
+static void
+WriteColumnarResults(const std::string& fileName,
+                     Ptr<FlowMonitor> flowMonitor,
+                     Ptr<Ipv4FlowClassifier> classifier,
+                     const NodeContainer& vehicles,
+                     const std::vector<uint32_t>& vehicleIndex,
+                     const NodeContainer& rsus)
 {
-    Time::SetResolution(Time::NS);
+    using namespace v2xcol;
+    static const FlowMonitor::FlowStatsContainer noFlows;
+    const FlowMonitor::FlowStatsContainer& flows =
+        flowMonitor ? flowMonitor->GetFlowStats() : noFlows;
 
-    // --- CLI defaults
-    bool enableFlowMonitor = true;
-    bool enablePcap = true;
-    bool enableNetAnim = false;
-    bool enableQueueTraces = true;
-    std::string netAnimFile = "v2x-sim-netanim.xml";
-    uint32_t nVehicles = 2;
-    double simTime = 12.0;
+    V2xColumnarWriter w;
+    const uint32_t flowTable = w.AddTable("flows",
+                                          flows.size(),
+                                          {{"flowId", U32},
+                                           {"srcAddr", U32},
+                                           {"dstAddr", U32},
+                                           {"srcPort", U32},
+                                           {"dstPort", U32},
+                                           {"protocol", U32},
+                                           {"txPackets", U64},
+                                           {"rxPackets", U64},
+                                           {"lostPackets", U64},
+                                           {"txBytes", U64},
+                                           {"rxBytes", U64},
+                                           {"firstTxNs", I64},
+                                           {"lastRxNs", I64},
+                                           {"delaySumNs", I64},
+                                           {"jitterSumNs", I64}});
+    const uint32_t nodeTable = w.AddTable("nodes",
+                                          vehicles.GetN() + rsus.GetN(),
+                                          {{"nodeId", U32},
+                                           {"vehicle", U32},
+                                           {"x", F64},
+                                           {"y", F64},
+                                           {"sent", U64},
+                                           {"received", U64},
+                                           {"meanLatencyNs", F64},
+                                           {"meanAoiNs", F64}});
+    w.Open(fileName);
 
-    CommandLine cmd;
-    cmd.AddValue("enableFlowMonitor", "Enable FlowMonitor", enableFlowMonitor);
-    cmd.AddValue("enablePcap", "Enable PCAP capture", enablePcap);
-    cmd.AddValue("enableNetAnim", "Enable NetAnim XML output", enableNetAnim);
-    cmd.AddValue("enableQueueTraces", "Enable Queue traces", enableQueueTraces);
-    cmd.AddValue("netAnimFile", "NetAnim filename", netAnimFile);
-    cmd.AddValue("nVehicles", "Number of vehicle nodes", nVehicles);
-    cmd.AddValue("simTime", "Simulation stop time (s)", simTime);
-    cmd.Parse(argc, argv);
+    uint64_t row = 0;
+    for (const auto& flow : flows)
+    {
+        const FlowMonitor::FlowStats& st = flow.second;
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        w.Set<uint32_t>(flowTable, 0, row, flow.first);
+        w.Set<uint32_t>(flowTable, 1, row, t.sourceAddress.Get());
+        w.Set<uint32_t>(flowTable, 2, row, t.destinationAddress.Get());
+        w.Set<uint32_t>(flowTable, 3, row, t.sourcePort);
+        w.Set<uint32_t>(flowTable, 4, row, t.destinationPort);
+        w.Set<uint32_t>(flowTable, 5, row, t.protocol);
+        w.Set<uint64_t>(flowTable, 6, row, st.txPackets);
+        w.Set<uint64_t>(flowTable, 7, row, st.rxPackets);
+        w.Set<uint64_t>(flowTable, 8, row, st.lostPackets);
+        w.Set<uint64_t>(flowTable, 9, row, st.txBytes);
+        w.Set<uint64_t>(flowTable, 10, row, st.rxBytes);
+        w.Set<int64_t>(flowTable, 11, row, st.timeFirstTxPacket.GetNanoSeconds());
+        w.Set<int64_t>(flowTable, 12, row, st.timeLastRxPacket.GetNanoSeconds());
+        w.Set<int64_t>(flowTable, 13, row, st.delaySum.GetNanoSeconds());
+        w.Set<int64_t>(flowTable, 14, row, st.jitterSum.GetNanoSeconds());
+        ++row;
+    }
 
-    std::cout << "V2XSimReliableFinal: nVehicles=" << nVehicles
-              << " simTime=" << simTime
+    for (uint32_t i = 0; i < vehicles.GetN() + rsus.GetN(); ++i)
+    {
+        const bool isRsu = i >= vehicles.GetN();
+        Ptr<Node> node = isRsu ? rsus.Get(i - vehicles.GetN()) : vehicles.Get(i);
+        Vector pos = node->GetObject<MobilityModel>()->GetPosition();
+        const uint32_t vehicle = isRsu ? UINT32_MAX : vehicleIndex[i];
+        w.Set<uint32_t>(nodeTable, 0, i, node->GetId());
+        w.Set<uint32_t>(nodeTable, 1, i, vehicle);
+        w.Set<double>(nodeTable, 2, i, pos.x);
+        w.Set<double>(nodeTable, 3, i, pos.y);
+        uint64_t sent = 0;
+        uint64_t received = 0;
+        double meanLatency = 0;
+        double meanAoi = 0;
+        if (!isRsu && vehicle < g_metrics.GetNVehicles())
+        {
+            const V2xMetricsCollector::Vehicle& v = g_metrics.GetVehicle(vehicle);
+            sent = v.sent;
+            received = v.received;
+            meanLatency = v.received ? v.latencySumNs / v.received : 0.0;
+            meanAoi = v.aoiSpanNs > 0 ? v.aoiAreaNs2 / v.aoiSpanNs : 0.0;
+        }
+        else if (isRsu && i - vehicles.GetN() < g_rsuCounters.size())
+        {
+            received = g_rsuCounters[i - vehicles.GetN()].rxPackets;
+        }
+        w.Set<uint64_t>(nodeTable, 4, i, sent);
+        w.Set<uint64_t>(nodeTable, 5, i, received);
+        w.Set<double>(nodeTable, 6, i, meanLatency);
+        w.Set<double>(nodeTable, 7, i, meanAoi);
+    }
+    w.Close();
+}
+
+ScenarioResult RunScenario(const ScenarioConfig& cfg)
+{
+    auto wallStart = std::chrono::steady_clock::now();
+    g_counters = {};
+    // --- Profile (counting scheduler before the first event is scheduled)
+    Ptr<V2xProfiler> profiler;
+    if (cfg.profile)
+    {
+        V2xProfiler::InstallScheduler();
+        profiler = Create<V2xProfiler>();
+        profiler->Mark("setup");
+    }
+    auto phase = [&profiler](const char* name) {
+        if (profiler)
+        {
+            profiler->Mark(name);
+        }
+    };
+    RngSeedManager::SetRun(cfg.rngRun);
+
+    std::cout << "V2XSimReliableFinal: nVehicles=" << cfg.nVehicles
+              << " simTime=" << cfg.simTime
+              << " topology=" << cfg.topo.layout
+              << " run=" << cfg.rngRun
+              << " build=" << V2xScenarioTraits::NAME
               << "\n";
+    // --- Build profile: a compiled-out subsystem cannot be asked for at run time
+    NS_ABORT_MSG_IF(cfg.logLevel > V2xEventLog::LEVEL_OFF && !V2xScenarioTraits::EVENT_LOG,
+                    "--logLevel needs a build with the event log (" << V2xScenarioTraits::NAME
+                                                                    << " profile)");
+    NS_ABORT_MSG_IF(cfg.logLevel >= V2xEventLog::LEVEL_QUEUE && cfg.enableQueueTraces &&
+                        !V2xScenarioTraits::QUEUE_EVENTS,
+                    "Queue-level event log needs a build with queue events ("
+                        << V2xScenarioTraits::NAME << " profile)");
+    NS_ABORT_MSG_IF(cfg.metrics && !V2xScenarioTraits::METRICS,
+                    "--metrics needs a build with metrics (" << V2xScenarioTraits::NAME
+                                                             << " profile)");
+    NS_ABORT_MSG_IF(cfg.phyTrace && !V2xScenarioTraits::PHY_TRACE,
+                    "--phyTrace needs a build with the PHY trace (" << V2xScenarioTraits::NAME
+                                                                    << " profile)");
+    NS_ABORT_MSG_IF(cfg.resultsFormat != "columnar" && cfg.resultsFormat != "xml" &&
+                        cfg.resultsFormat != "both" && cfg.resultsFormat != "none",
+                    "Unknown resultsFormat '" << cfg.resultsFormat << "' (columnar|xml|both|none)");
+
+    // --- Partition (distributed mode: this rank keeps one strip of vehicles)
+    uint32_t systemId = 0;
+    uint32_t nSystems = 1;
+#ifdef NS3_MPI
+    if (cfg.distributed)
+    {
+        systemId = MpiInterface::GetSystemId();
+        nSystems = MpiInterface::GetSize();
+    }
+#else
+    NS_ABORT_MSG_IF(cfg.distributed, "--distributed needs ns-3 built with --enable-mpi");
+#endif
+    NS_ABORT_MSG_IF(cfg.nRsus == 0, "--nRsus must be at least 1");
+    NS_ABORT_MSG_IF(nSystems > 1 && cfg.nRsus != 1,
+                    "--distributed places one RSU per rank; use --nRsus=1");
+    std::string outputPrefix = cfg.outputPrefix;
+    if (nSystems > 1)
+    {
+        outputPrefix += "-rank" + std::to_string(systemId);
+    }
+
+    // --- Snapshot (replaces topology, partitioning, RSU placement, association)
+    V2xSnapshot snapshot;
+    const bool restore = !cfg.snapshotLoad.empty();
+    if (restore)
+    {
+        snapshot.Load(cfg.snapshotLoad);
+        NS_ABORT_MSG_IF(snapshot.fingerprint != V2xSnapshot::Fingerprint(cfg, nSystems, systemId),
+                        cfg.snapshotLoad << " was saved for a different scenario setup");
+        for (uint32_t g : snapshot.globalIndex)
+        {
+            NS_ABORT_MSG_IF(g >= cfg.nVehicles,
+                            cfg.snapshotLoad << " holds vehicle " << g << ", the scenario has "
+                                             << cfg.nVehicles);
+        }
+        NS_ABORT_MSG_IF(nSystems == 1 && snapshot.globalIndex.size() != cfg.nVehicles,
+                        cfg.snapshotLoad << " holds " << snapshot.globalIndex.size()
+                                         << " vehicles, the scenario has " << cfg.nVehicles);
+        std::cout << "Snapshot " << cfg.snapshotLoad << ": " << snapshot.globalIndex.size()
+                  << " vehicles, " << snapshot.rsuPositions.size() << " RSUs, "
+                  << snapshot.macs.size() << " devices\n";
+    }
+
+    std::vector<Vector> globalPositions;
+    if (!restore)
+    {
+        globalPositions = V2xTopologyBuilder::Build(cfg.topo, cfg.nVehicles);
+    }
+    std::vector<uint32_t> vehicleIndex; // global vehicle index of each local vehicle
+    if (restore)
+    {
+        vehicleIndex = snapshot.globalIndex;
+    }
+    else if (nSystems > 1)
+    {
+        vehicleIndex = V2xPartitioner::Owned(V2xPartitioner::AssignStrips(globalPositions, nSystems),
+                                             systemId);
+    }
+    else
+    {
+        vehicleIndex.resize(cfg.nVehicles);
+        for (uint32_t i = 0; i < cfg.nVehicles; ++i)
+            vehicleIndex[i] = i;
+    }
+    const uint32_t nVehicles = vehicleIndex.size();
+    std::vector<Vector> vehiclePositions;
+    if (restore)
+    {
+        vehiclePositions = snapshot.vehiclePositions;
+    }
+    else
+    {
+        vehiclePositions.reserve(nVehicles);
+        for (uint32_t g : vehicleIndex)
+            vehiclePositions.push_back(globalPositions[g]);
+    }
+    // per-vehicle scenario state, one column per field
+    Ptr<V2xVehicleTable> vt = Create<V2xVehicleTable>();
+    vt->Init(std::move(vehicleIndex));
+
+    // --- Event log (flushed in blocks, closed at Simulator::Destroy)
+    g_eventLog.Configure(cfg.logLevel,
+                         cfg.logSampleRate,
+                         cfg.logFile.empty() ? outputPrefix + "-events.csv" : cfg.logFile,
+                         cfg.logBinary);
+    Simulator::ScheduleDestroy(&V2xEventLog::Close, &g_eventLog);
+    g_metrics.Configure(cfg.metrics ? cfg.nVehicles : 0);
+    // --- Shared payload templates (released at Simulator::Destroy)
+    V2xPayloads().SetPattern(cfg.payloadPattern);
+    Simulator::ScheduleDestroy(&V2xPayloadFactory::Clear, &V2xPayloads());
 
     // --- Nodes
+    phase("nodes");
     NodeContainer vehicles;
-    vehicles.Create(nVehicles);
     NodeContainer rsu;
-    rsu.Create(1);
+    if (nSystems > 1)
+    {
+        // every rank creates every RSU so the backhaul node ids agree;
+        // only the local one gets a radio
+        NodeContainer rsuBackbone;
+        for (uint32_t r = 0; r < nSystems; ++r)
+            rsuBackbone.Create(1, r);
+        rsu.Add(rsuBackbone.Get(systemId));
+        vehicles.Create(nVehicles, systemId);
+
+        PointToPointHelper backhaul;
+        backhaul.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+        backhaul.SetChannelAttribute("Delay", TimeValue(Seconds(cfg.mpiBackhaulDelay)));
+        InternetStackHelper backhaulStack;
+        backhaulStack.Install(rsuBackbone);
+        Ipv4AddressHelper backhaulIp;
+        backhaulIp.SetBase("172.16.0.0", "255.255.255.252");
+        for (uint32_t r = 0; r + 1 < nSystems; ++r)
+        {
+            backhaulIp.Assign(backhaul.Install(rsuBackbone.Get(r), rsuBackbone.Get(r + 1)));
+            backhaulIp.NewNetwork();
+        }
+    }
+    else
+    {
+        vehicles.Create(nVehicles);
+        rsu.Create(cfg.nRsus);
+    }
 
     NodeContainer allNodes;
     allNodes.Add(vehicles);
     allNodes.Add(rsu);
 
-    // --- Mobility
-    MobilityHelper mobility;
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    Ptr<ListPositionAllocator> posAlloc = CreateObject<ListPositionAllocator>();
-    for (uint32_t i = 0; i < nVehicles; ++i)
-        posAlloc->Add(Vector(5.0 + 20.0 * i, 0.0, 0.0));
-    posAlloc->Add(Vector(25.0, 50.0, 0.0)); // RSU
-    mobility.SetPositionAllocator(posAlloc);
-    mobility.Install(allNodes);
-
-    // --- Wifi
-    YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
-    YansWifiPhyHelper phy;
-    phy.SetChannel(channel.Create());
-
-    WifiHelper wifi;
-    wifi.SetStandard(WIFI_STANDARD_80211a);
-    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
-                                 "DataMode", StringValue("OfdmRate6Mbps"),
-                                 "ControlMode", StringValue("OfdmRate6Mbps"));
-
-    WifiMacHelper mac;
-    mac.SetType("ns3::AdhocWifiMac");
-    NetDeviceContainer devices = wifi.Install(phy, mac, allNodes);
-
-    // --- Internet
+    // --- Mobility (static layout, or streamed from a SUMO FCD / ns-2 trace)
+    Ptr<V2xTraceMobility> traceMobility;
+    V2xTopologyParams rsuLayout = cfg.topo;
+    if (!cfg.mobilityTrace.empty())
+    {
+        NS_ABORT_MSG_IF(nSystems > 1, "--mobilityTrace is not supported with --distributed");
+        traceMobility = Create<V2xTraceMobility>();
+        traceMobility->Open(cfg.mobilityTrace, cfg.mobilityFormat, Seconds(cfg.mobilityWindow));
+        traceMobility->Install(vehicles);
+        std::vector<Vector> seen = traceMobility->GetSeenPositions();
+        if (!seen.empty())
+        {
+            vehiclePositions = seen; // RSUs go where the trace starts
+            rsuLayout.layout = "trace";
+        }
+        std::cout << "Mobility trace " << cfg.mobilityTrace << ": " << seen.size()
+                  << " vehicles in the first " << 2 * cfg.mobilityWindow << " s\n";
+    }
+    else
+    {
+        V2xTopologyBuilder::Install(vehicles, vehiclePositions);
+    }
+    std::vector<Vector> rsuPositions =
+        restore       ? snapshot.rsuPositions
+        : nSystems > 1 ? std::vector<Vector>{V2xTopologyBuilder::BoundingBoxCentre(vehiclePositions)}
+                       : V2xTopologyBuilder::RsuPositions(rsuLayout, vehiclePositions, cfg.nRsus);
+    V2xTopologyBuilder::Install(rsu, rsuPositions);
+
+    // --- Position cache (one mobility evaluation per node per timestamp)
+    Ptr<V2xPositionStore> positions;
+    if (cfg.positionCache)
+    {
+        positions = Create<V2xPositionStore>();
+        positions->Add(allNodes);
+    }
+
+    // --- RSU association (nearest RSU, re-evaluated on a timer)
+    const uint32_t nRsus = rsu.GetN();
+    Ptr<V2xAssociationManager> assoc = Create<V2xAssociationManager>();
+    assoc->SetRsus(rsuPositions);
+    assoc->SetHysteresis(cfg.handoverHysteresis);
+    assoc->SetPositionStore(positions);
+    if (restore)
+    {
+        assoc->Initialize(vehicles, snapshot.association);
+    }
+    else
+    {
+        assoc->Initialize(vehicles);
+    }
+    g_rsuCounters.assign(nRsus, V2xRsuCounters{});
+
+    // --- Access layer (Wi-Fi adhoc/OCB or sidelink Mode 4)
+    phase("accessInstall");
+    Ptr<V2xAccessLayer> access = CreateAccessLayer(cfg, positions);
+    access->Install(vehicles, rsu);
+    std::cout << access->GetDescription();
+    // devices = one primary (CCH in OCB mode) device per node, vehicles first;
+    // schDevices[k] = SCH k devices of its vehicles, then one per RSU
+    const NetDeviceContainer& devices = access->GetDevices();
+    const uint32_t nSch = access->GetNServiceChannels();
+    std::vector<NetDeviceContainer> schDevices(nSch);
+    for (uint32_t k = 0; k < nSch; ++k)
+    {
+        schDevices[k] = access->GetServiceDevices(k);
+    }
+    NetDeviceContainer allDevices = access->GetAllDevices();
+    if (restore)
+    {
+        NS_ABORT_MSG_IF(snapshot.macs.size() != allDevices.GetN(),
+                        "Snapshot has " << snapshot.macs.size() << " devices, scenario "
+                                        << allDevices.GetN());
+        for (uint32_t i = 0; i < allDevices.GetN(); ++i)
+        {
+            allDevices.Get(i)->SetAddress(V2xSnapshot::IntToMac(snapshot.macs[i]));
+        }
+    }
+
+    // --- Internet (the distributed RSU already has its stack from the backhaul)
+    phase("internet");
     InternetStackHelper internet;
-    internet.Install(allNodes);
+    internet.Install(nSystems > 1 ? vehicles : allNodes);
 
+    // /24 as before, wider subnets once the nodes stop fitting
+    const char* subnetBase = "10.1.1.0";
+    const char* subnetMaskStr = "255.255.255.0";
+    if (devices.GetN() > 65533)
+    {
+        subnetBase = "10.0.0.0";
+        subnetMaskStr = "255.0.0.0";
+    }
+    else if (devices.GetN() > 253)
+    {
+        subnetBase = "10.1.0.0";
+        subnetMaskStr = "255.255.0.0";
+    }
+    Ipv4Mask subnetMask(subnetMaskStr);
     Ipv4AddressHelper ipv4;
-    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    ipv4.SetBase(subnetBase, subnetMaskStr);
     Ipv4InterfaceContainer interfaces = ipv4.Assign(devices);
+    // one further subnet of the same size per service channel
+    std::vector<Ipv4InterfaceContainer> schInterfaces(nSch);
+    for (uint32_t k = 0; k < nSch; ++k)
+    {
+        ipv4.NewNetwork();
+        schInterfaces[k] = ipv4.Assign(schDevices[k]);
+    }
 
-    // --- Pre-populate ARP cache
-    Ptr<NetDevice> rsuDev = devices.Get(nVehicles); // RSU device
-    Mac48Address rsuMac = Mac48Address::ConvertFrom(rsuDev->GetAddress());
-    Ipv4Address rsuIp = interfaces.GetAddress(nVehicles);
-
-    for (uint32_t i = 0; i < nVehicles; ++i)
+    // --- Pre-populate ARP cache (RSU devices follow the vehicles)
+    phase("arp");
+    std::vector<Ipv4Address> rsuIps(nRsus);
+    std::vector<Mac48Address> rsuMacs(nRsus);
+    for (uint32_t r = 0; r < nRsus; ++r)
     {
-        Ptr<Node> vehNode = vehicles.Get(i);
-        Ptr<Ipv4L3Protocol> ipv4proto = vehNode->GetObject<Ipv4L3Protocol>();
-        Ptr<ArpCache> arp = CreateObject<ArpCache>();
-        arp->SetAliveTimeout(Seconds(3600));
-        ArpCache::Entry *entry = arp->Add(rsuIp);
-        entry->SetMacAddress(rsuMac);
-        entry->MarkPermanent();
+        rsuIps[r] = interfaces.GetAddress(nVehicles + r);
+        rsuMacs[r] = Mac48Address::ConvertFrom(devices.Get(nVehicles + r)->GetAddress());
+    }
+    Ipv4Address rsuIp = rsuIps[0];
 
-        for (uint32_t j = 0; j < ipv4proto->GetNInterfaces(); j++)
+    // DATA goes to RSU r on the vehicle's service channel (the CCH without SCHs)
+    std::vector<std::vector<Ipv4Address>> rsuDataIps(std::max(nSch, 1u), rsuIps);
+    std::vector<std::vector<Mac48Address>> rsuDataMacs(std::max(nSch, 1u), rsuMacs);
+    for (uint32_t k = 0; k < nSch; ++k)
+    {
+        const uint32_t first = schDevices[k].GetN() - nRsus;
+        for (uint32_t r = 0; r < nRsus; ++r)
         {
-            Ptr<Ipv4Interface> iface = ipv4proto->GetInterface(j);
-            iface->SetArpCache(arp);
+            rsuDataIps[k][r] = schInterfaces[k].GetAddress(first + r);
+            rsuDataMacs[k][r] = Mac48Address::ConvertFrom(schDevices[k].Get(first + r)->GetAddress());
         }
-        std::cout << "Pre-populated ARP for Vehicle " << i
-                  << " → RSU " << rsuIp << " (" << rsuMac << ")\n";
+    }
+    // --- TAP gateway (real RSU software on the host takes RSU 0's DATA)
+    if (!cfg.tapDevice.empty())
+    {
+#if V2X_HAVE_TAP_BRIDGE
+        NS_ABORT_MSG_IF(nSch > 0 || nSystems > 1,
+                        "--tapDevice needs nServiceChannels=0 and a single process");
+        Ptr<V2xTapGateway> tap = Create<V2xTapGateway>();
+        tap->Install(rsu.Get(0), cfg.tapDevice);
+        tap->AddRoutes(devices, nVehicles, rsuIps[0]);
+        rsuDataIps[0][0] = tap->GetHostAddress();
+        std::cout << "TAP gateway: " << cfg.tapDevice << " = " << tap->GetHostAddress()
+                  << ", route " << subnetBase << "/" << subnetMaskStr << " via "
+                  << tap->GetRsuAddress() << " on the host\n";
+#else
+        NS_FATAL_ERROR("--tapDevice needs ns-3 built with the tap-bridge and csma modules");
+#endif
     }
 
-    // --- TrafficControl (QueueDisc) installation, avoid double-install
-    TrafficControlHelper tch;
-    tch.SetRootQueueDisc("ns3::PfifoFastQueueDisc");
+    vt->SetRsuAddresses(&rsuDataIps);
+    for (uint32_t i = 0; i < nVehicles; ++i)
+    {
+        vt->SetDataChannel(i, nSch > 0 ? V2xOcbChannels::ServiceChannelOf(i, nSch) : 0);
+        vt->SetRsu(i, assoc->GetRsu(i));
+    }
 
-    NetDeviceContainer devicesToInstall;
-    for (uint32_t i = 0; i < devices.GetN(); ++i)
+    if (cfg.arpMode == "shared")
+    {
+        // one permanent IP -> MAC table for every node, built once (per channel)
+        Ptr<V2xNeighborTable> neighbors = Create<V2xNeighborTable>();
+        neighbors->Build(interfaces);
+        neighbors->InstallShared(interfaces);
+        std::cout << "Shared neighbor table: " << neighbors->GetN() << " entries on "
+                  << interfaces.GetN() << " interfaces\n";
+        for (uint32_t k = 0; k < nSch; ++k)
+        {
+            Ptr<V2xNeighborTable> sch = Create<V2xNeighborTable>();
+            sch->Build(schInterfaces[k]);
+            sch->InstallShared(schInterfaces[k]);
+        }
+    }
+    else if (cfg.arpMode == "perNode")
     {
-        Ptr<NetDevice> dev = devices.Get(i);
-        Ptr<Node> node = dev->GetNode();
-        Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer>();
-        bool alreadyHas = false;
-        if (tc)
+        for (uint32_t i = 0; i < nVehicles; ++i)
         {
-            Ptr<QueueDisc> existing = tc->GetRootQueueDiscOnDevice(dev);
-            if (existing)
+            Ptr<Node> vehNode = vehicles.Get(i);
+            Ptr<Ipv4L3Protocol> ipv4proto = vehNode->GetObject<Ipv4L3Protocol>();
+            Ptr<ArpCache> arp = CreateObject<ArpCache>();
+            arp->SetAliveTimeout(Seconds(3600));
+            for (uint32_t r = 0; r < nRsus; ++r)
+            {
+                ArpCache::Entry *entry = arp->Add(rsuIps[r]);
+                entry->SetMacAddress(rsuMacs[r]);
+                entry->MarkPermanent();
+                if (nSch > 0)
+                {
+                    entry = arp->Add(rsuDataIps[vt->GetDataChannel(i)][r]);
+                    entry->SetMacAddress(rsuDataMacs[vt->GetDataChannel(i)][r]);
+                    entry->MarkPermanent();
+                }
+            }
+
+            for (uint32_t j = 0; j < ipv4proto->GetNInterfaces(); j++)
             {
-                alreadyHas = true;
+                Ptr<Ipv4Interface> iface = ipv4proto->GetInterface(j);
+                iface->SetArpCache(arp);
+            }
+            if (nRsus == 1)
+            {
+                std::cout << "Pre-populated ARP for Vehicle " << i
+                          << " → RSU " << rsuIp << " (" << rsuMacs[0] << ")\n";
+            }
+            else
+            {
+                std::cout << "Pre-populated ARP for Vehicle " << i
+                          << " → " << nRsus << " RSUs\n";
             }
         }
-        if (!alreadyHas)
+    }
+    else
+    {
+        NS_FATAL_ERROR("Unknown arpMode '" << cfg.arpMode << "' (perNode|shared)");
+    }
+
+    phase("qdisc");
+    // --- TrafficControl (QueueDisc) installation. Ipv4AddressHelper::Assign
+    //     has already put its default root qdisc on every device with a queue
+    //     interface, so the selected one replaces it instead of being skipped
+    //     as a duplicate; --queueDisc=keep leaves the default in place
+    NetDeviceContainer qdiscDevices;
+    if (cfg.queueDisc != "keep")
+    {
+        TrafficControlHelper tch;
+        if (cfg.queueDisc == "pfifoFast")
+        {
+            tch.SetRootQueueDisc("ns3::PfifoFastQueueDisc");
+        }
+        else if (cfg.queueDisc == "fqCoDel")
+        {
+            tch.SetRootQueueDisc("ns3::FqCoDelQueueDisc");
+        }
+        else if (cfg.queueDisc == "v2xPriority")
         {
-            devicesToInstall.Add(dev);
+            tch.SetRootQueueDisc("ns3::V2xPriorityQueueDisc");
         }
         else
         {
-            std::cout << "Skipping QueueDisc install on device " << i << " (already has root qdisc)\n";
+            NS_FATAL_ERROR("Unknown queueDisc '" << cfg.queueDisc
+                                                 << "' (keep|pfifoFast|fqCoDel|v2xPriority)");
         }
+
+        uint32_t replaced = 0;
+        for (uint32_t i = 0; i < allDevices.GetN(); ++i)
+        {
+            Ptr<NetDevice> dev = allDevices.Get(i);
+            if (!dev->GetObject<NetDeviceQueueInterface>())
+            {
+                continue; // queues inside the device (sidelink)
+            }
+            Ptr<TrafficControlLayer> tc = dev->GetNode()->GetObject<TrafficControlLayer>();
+            if (tc && tc->GetRootQueueDiscOnDevice(dev))
+            {
+                tch.Uninstall(dev);
+                ++replaced;
+            }
+            qdiscDevices.Add(dev);
+        }
+        if (qdiscDevices.GetN() > 0)
+        {
+            tch.Install(qdiscDevices);
+        }
+        std::cout << "TrafficControl: " << cfg.queueDisc << " on " << qdiscDevices.GetN()
+                  << " devices (" << replaced << " default qdiscs replaced)\n";
     }
 
-    if (devicesToInstall.GetN() > 0)
+    // --- Snapshot: check a restored setup, or save this one
+    if (restore || !cfg.snapshotSave.empty())
     {
-        tch.Install(devicesToInstall);
-        std::cout << "TrafficControl: installed QueueDiscs on "
-                  << devicesToInstall.GetN() << " devices\n";
+        std::vector<uint32_t> ips(allDevices.GetN());
+        for (uint32_t i = 0; i < allDevices.GetN(); ++i)
+        {
+            Ptr<NetDevice> dev = allDevices.Get(i);
+            Ptr<Ipv4> ip = dev->GetNode()->GetObject<Ipv4>();
+            ips[i] = ip->GetAddress(ip->GetInterfaceForDevice(dev), 0).GetLocal().Get();
+        }
+        if (restore)
+        {
+            NS_ABORT_MSG_IF(ips != snapshot.ipv4, "IPv4 assignment differs from " << cfg.snapshotLoad);
+        }
+        if (!cfg.snapshotSave.empty())
+        {
+            snapshot.fingerprint = V2xSnapshot::Fingerprint(cfg, nSystems, systemId);
+            snapshot.globalIndex = vt->GetGlobalIndices();
+            snapshot.vehiclePositions = vehiclePositions;
+            snapshot.rsuPositions = rsuPositions;
+            snapshot.association.resize(nVehicles);
+            for (uint32_t i = 0; i < nVehicles; ++i)
+            {
+                snapshot.association[i] = assoc->GetRsu(i);
+            }
+            snapshot.macs.resize(allDevices.GetN());
+            for (uint32_t i = 0; i < allDevices.GetN(); ++i)
+            {
+                snapshot.macs[i] =
+                    V2xSnapshot::MacToInt(Mac48Address::ConvertFrom(allDevices.Get(i)->GetAddress()));
+            }
+            snapshot.ipv4 = ips;
+            snapshot.Save(cfg.snapshotSave);
+            std::cout << "Snapshot saved to " << cfg.snapshotSave << "\n";
+        }
     }
-    else
+
+    // --- Queue statistics: sampled backlog histogram, totals from the qdiscs'
+    //     own counters; per-packet records only with the queue-level event log
+    Ptr<V2xQueueStats> queueStats;
+    if (cfg.enableQueueTraces)
     {
-        std::cout << "TrafficControl: no devices required QueueDisc install\n";
+        queueStats = Create<V2xQueueStats>();
+        queueStats->Attach(allDevices);
+        if constexpr (V2xScenarioTraits::QUEUE_EVENTS)
+        {
+            if (cfg.logLevel >= V2xEventLog::LEVEL_QUEUE)
+            {
+                queueStats->ConnectEvents(&QueueEventCallback<V2xEventLog::EVENT_ENQUEUE>,
+                                          &QueueEventCallback<V2xEventLog::EVENT_DEQUEUE>,
+                                          &QueueEventCallback<V2xEventLog::EVENT_DROP>);
+            }
+        }
+        queueStats->Start(Seconds(cfg.queueSampleInterval));
     }
 
-    // --- RSU socket
+    // --- RSU sockets
+    phase("apps");
     uint16_t port = 5000;
-    Ptr<Socket> rsuSocket = Socket::CreateSocket(rsu.Get(0), UdpSocketFactory::GetTypeId());
-    rsuSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), port));
-    rsuSocket->SetRecvCallback(MakeCallback(&ReceivePacket));
+    for (uint32_t r = 0; r < nRsus; ++r)
+    {
+        Ptr<Socket> rsuSocket = Socket::CreateSocket(rsu.Get(r), UdpSocketFactory::GetTypeId());
+        rsuSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), port));
+        rsuSocket->SetRecvCallback(MakeBoundCallback(&ReceivePacket<V2xScenarioTraits>, r));
+    }
 
     // --- Vehicle sockets
-    std::vector< Ptr<Socket> > vehicleSockets(nVehicles);
-    for (uint32_t i = 0; i < nVehicles; ++i)
-        vehicleSockets[i] = Socket::CreateSocket(vehicles.Get(i), UdpSocketFactory::GetTypeId());
+    Ptr<V2xSendScheduler> sendSched;
+    if (cfg.trafficMode == "scheduled")
+    {
+        for (uint32_t i = 0; i < nVehicles; ++i)
+            vt->SetSocket(i, Socket::CreateSocket(vehicles.Get(i), UdpSocketFactory::GetTypeId()));
 
-    // --- Schedule sends
-    double sendStart = 1.0;
-    for (uint32_t i = 0; i < nVehicles; ++i)
+        // --- Schedule sends (defaults: vehicle i sends at 1+i and 2+i)
+        sendSched = CreateSendScheduler(cfg.sendScheduler, Seconds(cfg.batchSlot));
+        sendSched->SetJitter(Seconds(cfg.sendJitter));
+        // the destination is read from the table, which the handover callback updates
+        sendSched->SetSendCallback([vt, port](uint32_t i) {
+            SendPacket<V2xScenarioTraits>(vt->GetSocket(i),
+                                          vt->GetDestination(i),
+                                          port,
+                                          vt->GetGlobalIndex(i) + 1);
+            ++g_rsuCounters[vt->GetRsu(i)].txPackets;
+        });
+        for (uint32_t i = 0; i < nVehicles; ++i)
+        {
+            sendSched->Add(i,
+                           Seconds(cfg.sendStart + cfg.sendStagger * vt->GetGlobalIndex(i)),
+                           Seconds(cfg.sendInterval),
+                           cfg.nSends);
+        }
+        sendSched->Start();
+    }
+    else if (cfg.trafficMode == "beacon")
     {
-        Ipv4Address rsuAddr = rsuIp;
-        uint32_t vehId = i + 1;
-        double tsend = sendStart + double(i);
-        Simulator::Schedule(Seconds(tsend),
-                            [sock = vehicleSockets[i], rsuAddr, port, vehId]() {
-                                SendPacket(sock, rsuAddr, port, vehId);
-                            });
-        Simulator::Schedule(Seconds(tsend + 1.0),
-                            [sock = vehicleSockets[i], rsuAddr, port, vehId]() {
-                                SendPacket(sock, rsuAddr, port, vehId);
-                            });
+        // --- RSU beacons to the subnet broadcast, vehicles react to the first one
+        uint16_t beaconPort = port + 1;
+        for (uint32_t r = 0; r < nRsus; ++r)
+        {
+            Ptr<Application> beacon = CreateSizedApplication<RsuBeaconApplication>(cfg.beaconPayload);
+            beacon->SetAttribute("Interval", TimeValue(Seconds(cfg.beaconInterval)));
+            beacon->SetAttribute("Destination",
+                                 Ipv4AddressValue(rsuIp.GetSubnetDirectedBroadcast(subnetMask)));
+            beacon->SetAttribute("Port", UintegerValue(beaconPort));
+            beacon->TraceConnectWithoutContext("Tx",
+                                               MakeCallback(&BeaconTxTrace<V2xScenarioTraits>));
+            rsu.Get(r)->AddApplication(beacon);
+            beacon->SetStartTime(Seconds(1.0));
+        }
+
+        for (uint32_t i = 0; i < nVehicles; ++i)
+        {
+            Ptr<Application> client = CreateSizedApplication<VehicleClientApplication>(cfg.beaconPayload);
+            vt->SetClient(i, client);
+            client->SetAttribute("BeaconPort", UintegerValue(beaconPort));
+            client->SetAttribute("Remote", Ipv4AddressValue(vt->GetDestination(i)));
+            client->SetAttribute("RemotePort", UintegerValue(port));
+            client->SetAttribute("DataInterval", TimeValue(Seconds(cfg.dataInterval)));
+            if (cfg.metrics)
+            {
+                client->SetAttribute("VehicleIndex", UintegerValue(vt->GetGlobalIndex(i)));
+            }
+            client->TraceConnectWithoutContext(
+                "Tx",
+                MakeBoundCallback(&VehicleTxTrace<V2xScenarioTraits>, PeekPointer(vt), i));
+            vehicles.Get(i)->AddApplication(client);
+            client->SetStartTime(Seconds(0.0));
+        }
+    }
+    else
+    {
+        NS_FATAL_ERROR("Unknown trafficMode '" << cfg.trafficMode << "' (scheduled|beacon)");
+    }
+
+    // --- V2V geo-broadcast (alongside the unicast traffic, vehicles only)
+    std::vector<Ptr<V2xGeoBroadcastApplication>> geoApps;
+    if (cfg.v2vInterval > 0)
+    {
+        const Ipv4Address v2vBroadcast = rsuIp.GetSubnetDirectedBroadcast(subnetMask);
+        for (uint32_t i = 0; i < nVehicles; ++i)
+        {
+            Ptr<V2xGeoBroadcastApplication> app = CreateObject<V2xGeoBroadcastApplication>();
+            app->SetAttribute("Interval", TimeValue(Seconds(cfg.v2vInterval)));
+            app->SetAttribute("PayloadSize", UintegerValue(cfg.v2vPayload));
+            app->SetAttribute("Destination", Ipv4AddressValue(v2vBroadcast));
+            app->SetAttribute("Port", UintegerValue(port + 2));
+            app->SetAttribute("MaxHops", UintegerValue(cfg.v2vMaxHops));
+            app->SetAttribute("AreaRadius", DoubleValue(cfg.v2vAreaRadius));
+            app->SetAttribute("ContentionMax", TimeValue(Seconds(cfg.v2vContention)));
+            app->SetAttribute("ContentionRange", DoubleValue(cfg.v2vContentionRange));
+            app->SetAttribute("DuplicateSlots", UintegerValue(cfg.v2vDuplicateSlots));
+            vehicles.Get(i)->AddApplication(app);
+            // first broadcasts spread over one interval
+            app->SetStartTime(Seconds(cfg.sendStart + cfg.v2vInterval * i / nVehicles));
+            geoApps.push_back(app);
+        }
+    }
+
+    assoc->SetHandoverCallback([vt](uint32_t i, uint32_t, uint32_t to) {
+        vt->SetRsu(i, to);
+        if (Ptr<Application> client = vt->GetClient(i))
+        {
+            client->SetAttribute("Remote", Ipv4AddressValue(vt->GetDestination(i)));
+        }
+    });
+
+    // --- DCC (CBR-driven send interval, TX power and data rate per vehicle)
+    Ptr<V2xDcc> dcc;
+    if (cfg.dcc != "off")
+    {
+        const bool scheduled = cfg.trafficMode == "scheduled";
+        NS_ABORT_MSG_IF(!scheduled && cfg.dataInterval <= 0,
+                        "--dcc in beacon mode needs periodic DATA (--dataInterval)");
+        dcc = Create<V2xDcc>(V2xDcc::Parse(cfg.dcc),
+                             Seconds(cfg.dccInterval),
+                             Seconds(scheduled ? cfg.sendInterval : cfg.dataInterval));
+        // CBR is measured on the channel the vehicle's DATA uses
+        std::vector<Ptr<NetDevice>> dataDevices(nVehicles);
+        for (uint32_t i = 0; i < nVehicles; ++i)
+        {
+            dataDevices[i] = nSch > 0 ? schDevices[vt->GetDataChannel(i)].Get(i / nSch) : devices.Get(i);
+        }
+        dcc->SetDevices(dataDevices);
+        // payload + UDP/IP + LLC + MAC header/FCS at 6 Mbps OFDM; one subframe on the sidelink
+        const uint32_t frameBytes = (scheduled ? 100 : cfg.beaconPayload) + 64;
+        const bool ocb = cfg.wifiMode == "ocb";
+        const uint32_t symbols = (16 + 8 * frameBytes + 6 + 23) / 24;
+        dcc->SetFrameAirtime(cfg.accessLayer == "sidelink"
+                                 ? MilliSeconds(1)
+                                 : MicroSeconds((ocb ? 40 : 20) + symbols * (ocb ? 8 : 4)));
+        if (scheduled)
+        {
+            dcc->SetIntervalCallback(
+                [sendSched](uint32_t i, Time interval) { sendSched->SetInterval(i, interval); });
+        }
+        else
+        {
+            dcc->SetIntervalCallback([vt](uint32_t i, Time interval) {
+                vt->GetClient(i)->SetAttribute("DataInterval", TimeValue(interval));
+            });
+        }
+        dcc->Start(Seconds(0));
+    }
+
+    if (nRsus > 1)
+    {
+        assoc->Start(Seconds(cfg.associationInterval));
     }
 
     // --- Tracing
-    if (enablePcap) phy.EnablePcapAll("v2x-sim-final", true);
+    V2xPcapCapture capture;
+    if (cfg.enablePcap)
+    {
+        if (V2xPcapCapture::IsDefault(cfg))
+        {
+            access->EnablePcap(outputPrefix);
+        }
+        else
+        {
+            capture.Configure(cfg, outputPrefix, vehicles, rsu);
+            access->EnableCapture(capture);
+            std::cout << "PCAP: " << capture.GetNInterfaces() << " interfaces (" << cfg.pcapNodes
+                      << "), " << cfg.pcapFormat << "\n";
+        }
+    }
 
-    AsciiTraceHelper ascii;
-    Ptr<OutputStreamWrapper> asciiStream = ascii.CreateFileStream("v2x-sim-final.tr");
-    phy.EnableAsciiAll(asciiStream);
+    if (cfg.phyTrace)
+    {
+        g_phyTrace.Open(outputPrefix + "-phy.bin");
+        access->ConnectPhyTrace(g_phyTrace);
+        Simulator::ScheduleDestroy(&V2xPhyTrace::Close, &g_phyTrace);
+    }
+    if (cfg.asciiTrace)
+    {
+        AsciiTraceHelper ascii;
+        access->EnableAscii(ascii.CreateFileStream(outputPrefix + ".tr"));
+    }
+
+    // --- Online statistics (per-RSU windows appended during the run)
+    Ptr<V2xOnlineStats> onlineStats;
+    if (cfg.statsInterval > 0)
+    {
+        std::vector<Ptr<NetDevice>> rsuDevices(nRsus);
+        for (uint32_t r = 0; r < nRsus; ++r)
+        {
+            rsuDevices[r] = devices.Get(nVehicles + r);
+        }
+        onlineStats = Create<V2xOnlineStats>();
+        onlineStats->Attach(&g_rsuCounters, rsuDevices);
+        onlineStats->Start(Seconds(cfg.statsInterval), outputPrefix + "-online.csv");
+    }
 
     // --- FlowMonitor
     FlowMonitorHelper fmHelper;
     Ptr<FlowMonitor> flowMonitor = nullptr;
-    if (enableFlowMonitor) flowMonitor = fmHelper.InstallAll();
+    if (cfg.enableFlowMonitor) flowMonitor = fmHelper.InstallAll();
 
     // --- Run
-    Simulator::Stop(Seconds(simTime));
+    phase("run");
+    if (profiler)
+    {
+        profiler->StartSampling(Seconds(cfg.profileInterval));
+    }
+    Ptr<V2xRealtimeMonitor> rtMonitor;
+    if (cfg.realtime)
+    {
+        rtMonitor = Create<V2xRealtimeMonitor>();
+        rtMonitor->Start(Seconds(cfg.realtimeProbeInterval), Seconds(cfg.realtimeDeadline));
+        if constexpr (V2xScenarioTraits::CALLBACK_TIMING)
+        {
+            g_rxBudget.Enable(std::chrono::nanoseconds(1000));
+        }
+    }
+    Simulator::Stop(Seconds(cfg.simTime));
+    auto runStart = std::chrono::steady_clock::now();
     Simulator::Run();
+    const double runWallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+    if (profiler)
+    {
+        profiler->StopSampling();
+    }
+    capture.Close();
+    if (onlineStats)
+    {
+        onlineStats->Close();
+        std::cout << "Online stats: " << onlineStats->GetWindows() << " windows in " << outputPrefix
+                  << "-online.csv\n";
+    }
+    if (!geoApps.empty())
+    {
+        uint64_t originated = 0, received = 0, duplicates = 0, relayed = 0, suppressed = 0,
+                 evicted = 0;
+        for (Ptr<V2xGeoBroadcastApplication> app : geoApps)
+        {
+            originated += app->GetOriginated();
+            received += app->GetReceived();
+            duplicates += app->GetDuplicates();
+            relayed += app->GetRelayed();
+            suppressed += app->GetSuppressed();
+            evicted += app->GetEvictedRelays();
+        }
+        std::cout << "V2V: " << originated << " originated, " << received << " received, "
+                  << duplicates << " duplicates, " << relayed << " relayed, " << suppressed
+                  << " relays suppressed, " << evicted << " evicted from full rings\n";
+    }
+    if (rtMonitor)
+    {
+        rtMonitor->PrintStats(std::cout);
+        rtMonitor->Write(outputPrefix);
+        if constexpr (V2xScenarioTraits::CALLBACK_TIMING)
+        {
+            g_rxBudget.PrintStats(std::cout, "ReceivePacket");
+        }
+    }
+    phase("results");
 
-    if (enableFlowMonitor && flowMonitor)
+    if (traceMobility)
+    {
+        std::cout << "Mobility trace: " << traceMobility->GetWaypoints() << " waypoints, "
+                  << traceMobility->GetSkipped() << " entries skipped\n";
+    }
+    if (positions)
+    {
+        std::cout << "Position cache: " << positions->GetEvaluations() << " evaluations, "
+                  << positions->GetHits() << " hits\n";
+    }
+    access->PrintStats(std::cout);
+    if (queueStats)
+    {
+        queueStats->Write(outputPrefix);
+        std::cout << "Queue stats: " << queueStats->GetNDevices() << " qdiscs, "
+                  << queueStats->GetSamples() << " samples, " << queueStats->GetTotalDrops()
+                  << " drops, in " << outputPrefix << "-queue.csv\n";
+    }
+    if (dcc)
+    {
+        dcc->PrintStats(std::cout);
+    }
+    if (cfg.queueDisc == "v2xPriority")
+    {
+        uint64_t staleDrops = 0;
+        uint64_t drops = 0;
+        for (uint32_t i = 0; i < qdiscDevices.GetN(); ++i)
+        {
+            Ptr<NetDevice> dev = qdiscDevices.Get(i);
+            Ptr<V2xPriorityQueueDisc> q = DynamicCast<V2xPriorityQueueDisc>(
+                dev->GetNode()->GetObject<TrafficControlLayer>()->GetRootQueueDiscOnDevice(dev));
+            if (q)
+            {
+                staleDrops += q->GetStaleBeaconDrops();
+                drops += q->GetStats().nTotalDroppedPackets;
+            }
+        }
+        std::cout << "V2X priority qdisc: " << drops << " drops, " << staleDrops
+                  << " of them stale beacons replaced by newer ones\n";
+    }
+    std::cout << "Payloads: " << V2xPayloads().GetCopies() << " packets from "
+              << V2xPayloads().GetNTemplates() << " shared templates\n";
+    if (sendSched)
+    {
+        std::cout << "Send scheduler " << sendSched->GetName() << ": "
+                  << sendSched->GetSends() << " sends in "
+                  << sendSched->GetEvents() << " events\n";
+    }
+
+    if (nRsus > 1)
+    {
+        // per-RSU load after the run
+        std::ofstream rsuCsv(outputPrefix + "-rsu.csv");
+        NS_ABORT_MSG_IF(!rsuCsv.is_open(), "Cannot open " << outputPrefix << "-rsu.csv");
+        rsuCsv << "rsu,node,x,y,associated,handoversIn,rxPackets,rxBytes,throughputKbps\n";
+        std::vector<uint32_t> load = assoc->GetLoad();
+        for (uint32_t r = 0; r < nRsus; ++r)
+        {
+            rsuCsv << r << ',' << rsu.Get(r)->GetId() << ',' << rsuPositions[r].x << ','
+                   << rsuPositions[r].y << ',' << load[r] << ',' << assoc->GetHandoversIn(r)
+                   << ',' << g_rsuCounters[r].rxPackets << ',' << g_rsuCounters[r].rxBytes << ','
+                   << g_rsuCounters[r].rxBytes * 8.0 / cfg.simTime / 1000.0 << '\n';
+        }
+        std::cout << "RSUs: " << nRsus << ", " << assoc->GetHandovers()
+                  << " handovers, per-RSU load in " << outputPrefix << "-rsu.csv\n";
+    }
+
+    ScenarioResult result;
+    result.nVehicles = cfg.nVehicles;
+    result.simTime = cfg.simTime;
+    result.rngRun = cfg.rngRun;
+    result.txPackets = g_counters.txPackets;
+    result.rxPackets = g_counters.rxPackets;
+    result.rxBytes = g_counters.rxBytes;
+    result.beaconPackets = g_counters.beaconPackets;
+    result.events = Simulator::GetEventCount();
+    result.runSeconds = runWallSeconds;
+    double delaySum = 0; // seconds
+    uint64_t delayedPackets = 0;
+
+    if (cfg.enableFlowMonitor && flowMonitor)
     {
         flowMonitor->CheckForLostPackets();
-        flowMonitor->SerializeToXmlFile("v2x-sim-final-flowmon.xml", true, true);
+        for (const auto& flow : flowMonitor->GetFlowStats())
+        {
+            delaySum += flow.second.delaySum.GetSeconds();
+            delayedPackets += flow.second.rxPackets;
+        }
+        if (cfg.resultsFormat == "xml" || cfg.resultsFormat == "both")
+        {
+            phase("flowmonSerialize");
+            flowMonitor->SerializeToXmlFile(outputPrefix + "-flowmon.xml", true, true);
+            phase("results");
+        }
+    }
+
+#ifdef NS3_MPI
+    if (nSystems > 1)
+    {
+        // per-rank counters summed on every rank
+        uint64_t local[6] = {result.txPackets, result.rxPackets, result.rxBytes, result.events,
+                             delayedPackets, result.beaconPackets};
+        uint64_t global[6];
+        MPI_Allreduce(local, global, 6, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+        double globalDelaySum = 0;
+        MPI_Allreduce(&delaySum, &globalDelaySum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        result.txPackets = global[0];
+        result.rxPackets = global[1];
+        result.rxBytes = global[2];
+        result.events = global[3];
+        delayedPackets = global[4];
+        result.beaconPackets = global[5];
+        delaySum = globalDelaySum;
+    }
+#endif
+    if (delayedPackets > 0)
+    {
+        result.meanDelayMs = delaySum * 1000.0 / delayedPackets;
+    }
+
+    if (g_metrics.IsEnabled())
+    {
+        g_metrics.Finish(Seconds(cfg.simTime).GetNanoSeconds());
+        g_metrics.WriteCsv(outputPrefix + "-metrics.csv");
+        V2xMetricsCollector::Totals totals = g_metrics.GetTotals();
+        V2xQuantileSketch& sketch = g_metrics.GetSketch();
+#ifdef NS3_MPI
+        if (nSystems > 1)
+        {
+            // Totals is uint64/double only; sum each field, and the sketch buckets
+            V2xMetricsCollector::Totals sum{};
+            MPI_Allreduce(&totals.sent, &sum.sent, 3, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(&totals.latencySumNs, &sum.latencySumNs, 4, MPI_DOUBLE, MPI_SUM,
+                          MPI_COMM_WORLD);
+            MPI_Allreduce(&totals.peakAoiCount, &sum.peakAoiCount, 1, MPI_UINT64_T, MPI_SUM,
+                          MPI_COMM_WORLD);
+            totals = sum;
+            std::vector<uint64_t>& buckets = sketch.GetBuckets();
+            MPI_Allreduce(MPI_IN_PLACE, buckets.data(), static_cast<int>(buckets.size()),
+                          MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+            sketch.Recount();
+        }
+#endif
+        result.latencyP50Ms = sketch.Quantile(0.50) / 1e6;
+        result.latencyP95Ms = sketch.Quantile(0.95) / 1e6;
+        result.latencyP99Ms = sketch.Quantile(0.99) / 1e6;
+        if (totals.aoiSpanNs > 0)
+        {
+            result.meanAoiMs = totals.aoiAreaNs2 / totals.aoiSpanNs / 1e6;
+        }
+        std::cout << "Metrics: sent=" << totals.sent << " received=" << totals.received
+                  << " pdr=" << (totals.sent ? double(totals.received) / totals.sent : 0.0)
+                  << " latency p50/p95/p99=" << result.latencyP50Ms << "/"
+                  << result.latencyP95Ms << "/" << result.latencyP99Ms << " ms"
+                  << " meanAoI=" << result.meanAoiMs << " ms\n";
+    }
+
+    if (cfg.resultsFormat == "columnar" || cfg.resultsFormat == "both")
+    {
+        WriteColumnarResults(outputPrefix + "-results.v2xcol",
+                             flowMonitor,
+                             DynamicCast<Ipv4FlowClassifier>(fmHelper.GetClassifier()),
+                             vehicles,
+                             vt->GetGlobalIndices(),
+                             rsu);
+    }
+
+    result.peakRssKb = V2xProfiler::PeakRssKb();
+    if (profiler)
+    {
+        profiler->Write(outputPrefix + "-profile.json");
+        std::cout << "Profile: " << profiler->GetEventsPerSecond() << " events/s, peak scheduler depth "
+                  << V2xCountingScheduler::GetPeakDepth() << ", peak RSS " << result.peakRssKb
+                  << " KiB -> " << outputPrefix << "-profile.json\n";
     }
 
     Simulator::Destroy();
-    return 0;
+
+    result.wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return result;
 }
 
+int main(int argc, char *argv[])
+{
+    Time::SetResolution(Time::NS);
+
+    // --- CLI defaults
+    ScenarioConfig cfg;
+    bool sweep = false;
+    V2xSweepSpec sweepSpec;
+    bool benchmark = false;
+    V2xBenchmarkSpec benchmarkSpec;
+
+    CommandLine cmd;
+    cfg.AddToCommandLine(cmd);
+    cmd.AddValue("sweep", "Run a parameter sweep in parallel processes", sweep);
+    cmd.AddValue("sweepVehicles", "sweep: comma list of nVehicles", sweepSpec.vehicles);
+    cmd.AddValue("sweepSimTimes", "sweep: comma list of simTime", sweepSpec.simTimes);
+    cmd.AddValue("sweepRuns", "sweep: comma list of RNG runs", sweepSpec.runs);
+    cmd.AddValue("sweepJobs", "sweep: concurrent processes (0 = hardware threads)", sweepSpec.jobs);
+    cmd.AddValue("sweepOutput", "sweep: merged results CSV", sweepSpec.output);
+    cmd.AddValue("benchmark", "Run the fixed benchmark matrix and write a baseline", benchmark);
+    cmd.AddValue("benchmarkMaxVehicles", "benchmark: skip points with more vehicles", benchmarkSpec.maxVehicles);
+    cmd.AddValue("benchmarkJobs", "benchmark: concurrent processes (1 = undisturbed timings)", benchmarkSpec.jobs);
+    cmd.AddValue("benchmarkOutput", "benchmark: prefix of the baseline .csv/.json", benchmarkSpec.output);
+    cmd.Parse(argc, argv);
+
+    if (cfg.realtime)
+    {
+        NS_ABORT_MSG_IF(cfg.distributed || sweep || benchmark,
+                        "--realtime runs a single scenario in one process");
+        V2xRealtimeMonitor::Enable(Seconds(cfg.realtimeHardLimit));
+    }
+    if (!cfg.tapDevice.empty())
+    {
+        NS_ABORT_MSG_IF(!cfg.realtime, "--tapDevice needs --realtime");
+        GlobalValue::Bind("ChecksumEnabled", BooleanValue(true));
+    }
+
+    if (cfg.distributed)
+    {
+#ifdef NS3_MPI
+        NS_ABORT_MSG_IF(sweep || benchmark, "--sweep/--benchmark and --distributed cannot be combined");
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::DistributedSimulatorImpl"));
+        MpiInterface::Enable(&argc, &argv);
+        ScenarioResult r = RunScenario(cfg);
+        if (MpiInterface::GetSystemId() == 0)
+        {
+            std::cout << "Distributed: " << MpiInterface::GetSize() << " ranks, tx="
+                      << r.txPackets << " rx=" << r.rxPackets << " pdr=" << r.GetPdr() << "\n";
+        }
+        MpiInterface::Disable();
+        return 0;
+#else
+        NS_FATAL_ERROR("--distributed needs ns-3 built with --enable-mpi");
+#endif
+    }
+
+    if (benchmark)
+    {
+        NS_ABORT_MSG_IF(sweep, "--sweep and --benchmark cannot be combined");
+        return V2xBenchmark::Run(cfg, benchmarkSpec) == 0 ? 0 : 1;
+    }
+
+    if (sweep)
+    {
+        std::vector<ScenarioConfig> configs = V2xSweepRunner::Expand(cfg, sweepSpec);
+        return V2xSweepRunner::Run(configs, sweepSpec.jobs, sweepSpec.output) == 0 ? 0 : 1;
+    }
+
+    RunScenario(cfg);
+    return 0;
+}
@@ -0,0 +1,496 @@
+/* v2x-access-layer.h
+ *
+ * Radio access layer behind one scenario-level interface (--accessLayer).
+ * - wifi: 802.11a AdhocWifiMac or 802.11p OCB (--wifiMode), on the Yans
+ *   or grid spectrum channel (--channelModel)
+ * - sidelink: LTE-V2X Mode 4 semi-persistent scheduling (v2x-sidelink.h)
+ * - Both install one primary device per node, vehicles first, so the IP,
+ *   ARP, traffic, metrics and sweep code above them is shared; OCB service
+ *   channels are extra device sets
+ * - Tracing (pcap, selective capture, ASCII, binary PHY trace) and
+ *   end-of-run statistics go through the layer, since only it knows its
+ *   device type
+ */
+
+#ifndef V2X_ACCESS_LAYER_H
+#define V2X_ACCESS_LAYER_H
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/spectrum-wifi-helper.h"
+#include "ns3/string.h"
+#include "ns3/trace-helper.h"
+#include "ns3/uinteger.h"
+#include "ns3/wave-mac-helper.h"
+#include "ns3/wifi-80211p-helper.h"
+#include "ns3/wifi-helper.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include "v2x-grid-spectrum-channel.h"
+#include "v2x-loss-table.h"
+#include "v2x-ocb.h"
+#include "v2x-pcap.h"
+#include "v2x-phy-trace.h"
+#include "v2x-position-store.h"
+#include "v2x-scenario.h"
+#include "v2x-sidelink.h"
+
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xAccessLayer : public SimpleRefCount<V2xAccessLayer>
+{
+  public:
+    virtual ~V2xAccessLayer() = default;
+
+    /// Primary device on every vehicle then every RSU, plus any extra sets.
+    virtual void Install(const NodeContainer& vehicles, const NodeContainer& rsus) = 0;
+
+    virtual void EnablePcap(const std::string& prefix) = 0;
+    /// Feed the selected devices' frames into `capture` (outlives the run).
+    virtual void EnableCapture(V2xPcapCapture& capture) = 0;
+    virtual void EnableAscii(Ptr<OutputStreamWrapper> stream) = 0;
+    virtual void ConnectPhyTrace(V2xPhyTrace& trace) = 0;
+
+    /// End-of-run access layer statistics, one or more lines.
+    virtual void PrintStats(std::ostream&) const
+    {
+    }
+
+    /// Setup summary lines for the console.
+    std::string GetDescription() const
+    {
+        return m_description.str();
+    }
+
+    /// One device per node, vehicles first.
+    const NetDeviceContainer& GetDevices() const
+    {
+        return m_devices;
+    }
+
+    uint32_t GetNServiceChannels() const
+    {
+        return static_cast<uint32_t>(m_sch.size());
+    }
+
+    /// Service channel `k` devices: its vehicles, then one per RSU.
+    const NetDeviceContainer& GetServiceDevices(uint32_t k) const
+    {
+        return m_sch[k];
+    }
+
+    NetDeviceContainer GetAllDevices() const
+    {
+        NetDeviceContainer all = m_devices;
+        for (const NetDeviceContainer& d : m_sch)
+        {
+            all.Add(d);
+        }
+        return all;
+    }
+
+  protected:
+    NetDeviceContainer m_devices;
+    std::vector<NetDeviceContainer> m_sch;
+    std::ostringstream m_description;
+};
+
+class V2xWifiAccessLayer : public V2xAccessLayer
+{
+  public:
+    V2xWifiAccessLayer(const ScenarioConfig& cfg, Ptr<V2xPositionStore> positions)
+        : m_cfg(cfg),
+          m_positions(positions)
+    {
+    }
+
+    void Install(const NodeContainer& vehicles, const NodeContainer& rsus) override
+    {
+        NodeContainer allNodes(vehicles, rsus);
+        const uint32_t nSch = m_cfg.wifiMode == "ocb" ? m_cfg.nServiceChannels : 0;
+        if (m_cfg.wifiMode == "adhoc")
+        {
+            NS_ABORT_MSG_IF(m_cfg.nServiceChannels > 0, "--nServiceChannels needs --wifiMode=ocb");
+            AttachChannel(true);
+            WifiHelper wifi;
+            wifi.SetStandard(WIFI_STANDARD_80211a);
+            wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                         "DataMode", StringValue("OfdmRate6Mbps"),
+                                         "ControlMode", StringValue("OfdmRate6Mbps"));
+
+            WifiMacHelper mac;
+            mac.SetType("ns3::AdhocWifiMac");
+            m_devices = wifi.Install(Phy(), mac, allNodes);
+        }
+        else if (m_cfg.wifiMode == "ocb")
+        {
+            NS_ABORT_MSG_IF(nSch > V2xOcbChannels::MAX_SCH,
+                            "--nServiceChannels must be at most " << V2xOcbChannels::MAX_SCH);
+            Wifi80211pHelper wifi = Wifi80211pHelper::Default();
+            wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                         "DataMode", StringValue("OfdmRate6MbpsBW10MHz"),
+                                         "ControlMode", StringValue("OfdmRate6MbpsBW10MHz"));
+            NqosWaveMacHelper mac = NqosWaveMacHelper::Default();
+
+            AttachChannel(true);
+            Phy().Set("ChannelSettings", StringValue(V2xOcbChannels::Settings(V2xOcbChannels::CCH)));
+            m_devices = wifi.Install(Phy(), mac, allNodes);
+            m_sch.resize(nSch);
+            for (uint32_t k = 0; k < nSch; ++k)
+            {
+                NodeContainer members;
+                for (uint32_t i = 0; i < vehicles.GetN(); ++i)
+                {
+                    if (V2xOcbChannels::ServiceChannelOf(i, nSch) == k)
+                    {
+                        members.Add(vehicles.Get(i));
+                    }
+                }
+                members.Add(rsus);
+                AttachChannel(false);
+                Phy().Set("ChannelSettings",
+                          StringValue(V2xOcbChannels::Settings(V2xOcbChannels::Sch(k))));
+                m_sch[k] = wifi.Install(Phy(), mac, members);
+            }
+            m_description << "802.11p OCB: CCH " << V2xOcbChannels::CCH << " + " << nSch
+                          << " service channels, 10 MHz\n";
+        }
+        else
+        {
+            NS_FATAL_ERROR("Unknown wifiMode '" << m_cfg.wifiMode << "' (adhoc|ocb)");
+        }
+    }
+
+    void EnablePcap(const std::string& prefix) override
+    {
+        Phy().EnablePcapAll(prefix, true);
+    }
+
+    void EnableAscii(Ptr<OutputStreamWrapper> stream) override
+    {
+        Phy().EnableAsciiAll(stream);
+    }
+
+    void EnableCapture(V2xPcapCapture& capture) override
+    {
+        // monitor sniffers: every frame sent or decoded, as EnablePcapAll(promiscuous)
+        NetDeviceContainer all = GetAllDevices();
+        for (uint32_t i = 0; i < all.GetN(); ++i)
+        {
+            Ptr<WifiNetDevice> dev = DynamicCast<WifiNetDevice>(all.Get(i));
+            if (!dev || !capture.IsSelected(dev))
+            {
+                continue;
+            }
+            const uint32_t id = capture.AddInterface(dev, V2xPcapCapture::LINK_IEEE802_11);
+            dev->GetPhy()->TraceConnectWithoutContext("MonitorSnifferTx",
+                                                      MakeBoundCallback(&SniffTx, &capture, id));
+            dev->GetPhy()->TraceConnectWithoutContext("MonitorSnifferRx",
+                                                      MakeBoundCallback(&SniffRx, &capture, id));
+        }
+    }
+
+    void ConnectPhyTrace(V2xPhyTrace& trace) override
+    {
+        trace.Connect(GetAllDevices());
+    }
+
+  private:
+    static void SniffTx(V2xPcapCapture* capture,
+                        uint32_t id,
+                        Ptr<const Packet> p,
+                        uint16_t,
+                        WifiTxVector,
+                        MpduInfo,
+                        uint16_t)
+    {
+        V2xPcapCapture::Frame(capture, id, p);
+    }
+
+    static void SniffRx(V2xPcapCapture* capture,
+                        uint32_t id,
+                        Ptr<const Packet> p,
+                        uint16_t,
+                        WifiTxVector,
+                        MpduInfo,
+                        SignalNoiseDbm,
+                        uint16_t)
+    {
+        V2xPcapCapture::Frame(capture, id, p);
+    }
+
+    WifiPhyHelper& Phy()
+    {
+        return m_cfg.channelModel == "grid" ? static_cast<WifiPhyHelper&>(m_spectrumPhy)
+                                            : m_yansPhy;
+    }
+
+    /// A fresh channel object on the PHY helper; once per OCB channel.
+    void AttachChannel(bool report)
+    {
+        const bool lossTable = m_cfg.lossModel == "table";
+        if (m_cfg.channelModel == "yans")
+        {
+            YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
+            if (lossTable)
+            {
+                // Default() minus its LogDistance loss, same ConstantSpeed delay
+                channel = YansWifiChannelHelper();
+                channel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+                channel.AddPropagationLoss("ns3::V2xTabulatedLossModel",
+                                           "MantissaBits", UintegerValue(m_cfg.lossTableBits));
+            }
+            m_yansPhy.SetChannel(channel.Create());
+        }
+        else if (m_cfg.channelModel == "grid")
+        {
+            // same LogDistance/ConstantSpeed models as YansWifiChannelHelper::Default(),
+            // cut off where the default TX power falls below the default RX sensitivity
+            const double txPowerDbm = 16.0206;
+            const double rxSensitivityDbm = -101.0;
+            double maxRange = m_cfg.maxRange;
+            if (maxRange <= 0)
+            {
+                maxRange = LogDistanceRange(txPowerDbm, rxSensitivityDbm);
+            }
+            Ptr<GridSpectrumChannel> gridChannel = CreateObject<GridSpectrumChannel>();
+            gridChannel->SetAttribute("MaxRange", DoubleValue(maxRange));
+            gridChannel->SetAttribute("MaxLossDb", DoubleValue(txPowerDbm - rxSensitivityDbm));
+            Ptr<V2xTabulatedLossModel> table;
+            if (lossTable)
+            {
+                table = CreateObjectWithAttributes<V2xTabulatedLossModel>(
+                    "MantissaBits", UintegerValue(m_cfg.lossTableBits));
+                gridChannel->AddPropagationLossModel(table);
+            }
+            else
+            {
+                gridChannel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+            }
+            gridChannel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+            if (m_positions && table)
+            {
+                gridChannel->SetPositionStore(m_positions);
+                gridChannel->SetDistanceLossBatch([table](const double* d2, double* lossDb, size_t n) {
+                    table->GetTable().LossDbBatch(d2, lossDb, n);
+                });
+            }
+            else if (m_positions)
+            {
+                gridChannel->SetPositionStore(m_positions);
+                gridChannel->SetDistanceLoss([](double d2) { return LogDistanceLossDb(d2); });
+            }
+            m_spectrumPhy.SetChannel(gridChannel);
+            if (report)
+            {
+                m_description << "Grid channel: maxRange=" << maxRange << " m\n";
+                if (table)
+                {
+                    m_description << "Loss table: " << table->GetTable().GetSize()
+                                  << " bins, max error " << table->GetTable().MaxErrorDb()
+                                  << " dB\n";
+                }
+            }
+        }
+        else
+        {
+            NS_FATAL_ERROR("Unknown channelModel '" << m_cfg.channelModel << "' (yans|grid)");
+        }
+    }
+
+    const ScenarioConfig& m_cfg;
+    Ptr<V2xPositionStore> m_positions;
+    YansWifiPhyHelper m_yansPhy;
+    SpectrumWifiPhyHelper m_spectrumPhy;
+};
+
+class V2xSidelinkAccessLayer : public V2xAccessLayer
+{
+  public:
+    V2xSidelinkAccessLayer(const ScenarioConfig& cfg, Ptr<V2xPositionStore> positions)
+        : m_cfg(cfg),
+          m_positions(positions)
+    {
+    }
+
+    void Install(const NodeContainer& vehicles, const NodeContainer& rsus) override
+    {
+        NS_ABORT_MSG_IF(m_cfg.nServiceChannels > 0, "--nServiceChannels is a Wi-Fi OCB option");
+        NS_ABORT_MSG_IF(m_cfg.channelModel != "yans",
+                        "--channelModel is a Wi-Fi option; the sidelink has its own channel");
+        m_channel = CreateObject<V2xSidelinkChannel>();
+        m_channel->SetAttribute("NumSubchannels", UintegerValue(m_cfg.slSubchannels));
+        if (m_cfg.lossModel == "table")
+        {
+            Ptr<V2xTabulatedLossModel> table = CreateObjectWithAttributes<V2xTabulatedLossModel>(
+                "MantissaBits", UintegerValue(m_cfg.lossTableBits));
+            m_channel->SetPropagationLossModel(table);
+            if (m_positions)
+            {
+                m_channel->SetPositionStore(m_positions, [table](double d2) {
+                    return table->GetTable().LossDb(d2);
+                });
+            }
+        }
+        else
+        {
+            m_channel->SetPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+            if (m_positions)
+            {
+                m_channel->SetPositionStore(m_positions,
+                                            [](double d2) { return LogDistanceLossDb(d2); });
+            }
+        }
+        NodeContainer allNodes(vehicles, rsus);
+        for (uint32_t i = 0; i < allNodes.GetN(); ++i)
+        {
+            Ptr<V2xSidelinkNetDevice> dev = CreateObject<V2xSidelinkNetDevice>();
+            dev->SetAttribute("ReservationInterval", TimeValue(MilliSeconds(m_cfg.slReservation)));
+            dev->SetAddress(Mac48Address::Allocate());
+            allNodes.Get(i)->AddDevice(dev);
+            dev->SetChannel(m_channel);
+            m_devices.Add(dev);
+        }
+        m_description << "Sidelink Mode 4 SPS: " << m_cfg.slSubchannels << " subchannels x "
+                      << m_channel->GetSubchannelBytes() << " bytes, reservation "
+                      << m_cfg.slReservation << " ms\n";
+    }
+
+    void EnablePcap(const std::string& prefix) override
+    {
+        // raw IP, one file per device as for Wi-Fi
+        PcapHelper pcap;
+        for (uint32_t i = 0; i < m_devices.GetN(); ++i)
+        {
+            Ptr<NetDevice> dev = m_devices.Get(i);
+            Ptr<PcapFileWrapper> file = pcap.CreateFile(pcap.GetFilenameFromDevice(prefix, dev),
+                                                        std::ios::out,
+                                                        PcapHelper::DLT_RAW);
+            pcap.HookDefaultSink<NetDevice>(dev, "PhyTx", file);
+            pcap.HookDefaultSink<NetDevice>(dev, "PhyRxOk", file);
+        }
+    }
+
+    void EnableAscii(Ptr<OutputStreamWrapper> stream) override
+    {
+        for (uint32_t i = 0; i < m_devices.GetN(); ++i)
+        {
+            Ptr<NetDevice> dev = m_devices.Get(i);
+            dev->TraceConnectWithoutContext(
+                "PhyTx",
+                MakeBoundCallback(&AsciiTraceHelper::DefaultEnqueueSinkWithoutContext, stream));
+            dev->TraceConnectWithoutContext(
+                "PhyRxOk",
+                MakeBoundCallback(&AsciiTraceHelper::DefaultReceiveSinkWithoutContext, stream));
+            dev->TraceConnectWithoutContext(
+                "MacTxDrop",
+                MakeBoundCallback(&AsciiTraceHelper::DefaultDropSinkWithoutContext, stream));
+        }
+    }
+
+    void EnableCapture(V2xPcapCapture& capture) override
+    {
+        for (uint32_t i = 0; i < m_devices.GetN(); ++i)
+        {
+            Ptr<NetDevice> dev = m_devices.Get(i);
+            if (!capture.IsSelected(dev))
+            {
+                continue;
+            }
+            const uint32_t id = capture.AddInterface(dev, V2xPcapCapture::LINK_RAW);
+            dev->TraceConnectWithoutContext("PhyTx",
+                                            MakeBoundCallback(&V2xPcapCapture::Frame, &capture, id));
+            dev->TraceConnectWithoutContext("PhyRxOk",
+                                            MakeBoundCallback(&V2xPcapCapture::Frame, &capture, id));
+        }
+    }
+
+    void ConnectPhyTrace(V2xPhyTrace& trace) override
+    {
+        const uint32_t rateKbps = m_channel->GetSubchannelBytes() * 8; // per subchannel
+        for (uint32_t i = 0; i < m_devices.GetN(); ++i)
+        {
+            Ptr<NetDevice> dev = m_devices.Get(i);
+            const uint32_t node = dev->GetNode()->GetId();
+            const uint8_t devFlags = static_cast<uint8_t>((dev->GetIfIndex() & 0x0f) << 4);
+            dev->TraceConnectWithoutContext(
+                "PhyTx",
+                MakeBoundCallback(&PhyTraceSink, &trace, V2xPhyTrace::EVENT_TX, node, devFlags, rateKbps));
+            dev->TraceConnectWithoutContext(
+                "PhyRxOk",
+                MakeBoundCallback(&PhyTraceSink, &trace, V2xPhyTrace::EVENT_RX_OK, node, devFlags, rateKbps));
+            dev->TraceConnectWithoutContext(
+                "PhyRxDrop",
+                MakeBoundCallback(&PhyTraceSink, &trace, V2xPhyTrace::EVENT_RX_ERROR, node, devFlags, 0u));
+        }
+    }
+
+    void PrintStats(std::ostream& os) const override
+    {
+        const V2xSidelinkChannel::Stats& st = m_channel->GetStats();
+        double cbrSum = 0;
+        uint64_t reselections = 0;
+        for (uint32_t i = 0; i < m_devices.GetN(); ++i)
+        {
+            Ptr<V2xSidelinkNetDevice> dev = DynamicCast<V2xSidelinkNetDevice>(m_devices.Get(i));
+            cbrSum += dev->GetChannelBusyRatio();
+            reselections += dev->GetReselections();
+        }
+        os << "Sidelink: " << st.transmissions << " transmissions, " << st.received
+           << " receptions, " << st.sinrFailures << " lost to interference, " << st.halfDuplex
+           << " missed (half duplex), " << reselections << " resource selections, final mean CBR "
+           << (m_devices.GetN() ? cbrSum / m_devices.GetN() : 0.0) << '\n';
+    }
+
+  private:
+    /// rateKbps is per subchannel; scaled by the subchannels the packet used.
+    static void PhyTraceSink(V2xPhyTrace* trace,
+                             V2xPhyTrace::Event type,
+                             uint32_t node,
+                             uint8_t devFlags,
+                             uint32_t rateKbps,
+                             Ptr<const Packet> p)
+    {
+        const uint32_t bytesPerSub = rateKbps / 8;
+        const uint32_t nSub = bytesPerSub ? (p->GetSize() + bytesPerSub - 1) / bytesPerSub : 0;
+        trace->Record(type, node, devFlags, p->GetSize(), rateKbps * nSub);
+    }
+
+    const ScenarioConfig& m_cfg;
+    Ptr<V2xPositionStore> m_positions;
+    Ptr<V2xSidelinkChannel> m_channel;
+};
+
+/// "wifi" | "sidelink"; the layer keeps a reference to `cfg`.
+inline Ptr<V2xAccessLayer>
+CreateAccessLayer(const ScenarioConfig& cfg, Ptr<V2xPositionStore> positions)
+{
+    NS_ABORT_MSG_IF(cfg.lossModel != "logDistance" && cfg.lossModel != "table",
+                    "Unknown lossModel '" << cfg.lossModel << "' (logDistance|table)");
+    if (cfg.accessLayer == "wifi")
+    {
+        return Create<V2xWifiAccessLayer>(cfg, positions);
+    }
+    if (cfg.accessLayer == "sidelink")
+    {
+        return Create<V2xSidelinkAccessLayer>(cfg, positions);
+    }
+    NS_FATAL_ERROR("Unknown accessLayer '" << cfg.accessLayer << "' (wifi|sidelink)");
+    return nullptr;
+}
+
+} // namespace ns3
+
+#endif /* V2X_ACCESS_LAYER_H */
@@ -0,0 +1,337 @@
+/* v2x-association.h
+ *
+ * Vehicle -> RSU association for multi-RSU deployments.
+ * - RSU positions are binned into a uniform grid; the nearest RSU to a
+ *   point is found by searching rings of cells outwards from its cell
+ * - Associations are re-evaluated for all vehicles on a timer, not per
+ *   packet; senders just read GetRsu(idx)
+ * - A vehicle hands over only when another RSU is closer by more than the
+ *   hysteresis margin, and a callback lets the caller retarget its sender
+ * - Vehicle positions come from a V2xPositionStore when one is set
+ */
+
+#ifndef V2X_ASSOCIATION_H
+#define V2X_ASSOCIATION_H
+
+#include "ns3/abort.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/vector.h"
+
+#include "v2x-position-store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/// Nearest-point queries over a fixed set of RSU positions.
+class V2xRsuIndex
+{
+  public:
+    void Build(const std::vector<Vector>& rsus)
+    {
+        NS_ABORT_MSG_IF(rsus.empty(), "RSU index needs at least one RSU");
+        m_rsus = rsus;
+        m_cells.clear();
+        double minX = rsus[0].x;
+        double maxX = minX;
+        double minY = rsus[0].y;
+        double maxY = minY;
+        for (const Vector& v : rsus)
+        {
+            minX = std::min(minX, v.x);
+            maxX = std::max(maxX, v.x);
+            minY = std::min(minY, v.y);
+            maxY = std::max(maxY, v.y);
+        }
+        // about one RSU per cell on average
+        double area = std::max(1.0, (maxX - minX) * (maxY - minY));
+        double span = std::max(maxX - minX, maxY - minY);
+        m_cellSize = std::max({1.0, std::sqrt(area / rsus.size()), span / rsus.size()});
+        m_minCx = m_maxCx = CellOf(rsus[0].x);
+        m_minCy = m_maxCy = CellOf(rsus[0].y);
+        for (uint32_t i = 0; i < rsus.size(); ++i)
+        {
+            int64_t cx = CellOf(rsus[i].x);
+            int64_t cy = CellOf(rsus[i].y);
+            m_minCx = std::min(m_minCx, cx);
+            m_maxCx = std::max(m_maxCx, cx);
+            m_minCy = std::min(m_minCy, cy);
+            m_maxCy = std::max(m_maxCy, cy);
+            m_cells[Key(cx, cy)].push_back(i);
+        }
+    }
+
+    /// Index of the RSU nearest to `p`; `distance` receives its distance.
+    uint32_t Nearest(const Vector& p, double& distance) const
+    {
+        const int64_t cx = CellOf(p.x);
+        const int64_t cy = CellOf(p.y);
+        uint32_t best = 0;
+        double best2 = std::numeric_limits<double>::infinity();
+        const int64_t maxRing = std::max({std::abs(cx - m_minCx),
+                                          std::abs(cx - m_maxCx),
+                                          std::abs(cy - m_minCy),
+                                          std::abs(cy - m_maxCy)});
+        // far outside the RSU area the rings are mostly empty; once they
+        // would cost more than a scan, scan instead
+        const size_t scanCost = 4 * m_rsus.size() + 16;
+        size_t visited = 0;
+        for (int64_t r = 0; r <= maxRing; ++r)
+        {
+            // everything in ring r is at least (r - 1) cells away
+            const double nearest = (r - 1) * m_cellSize;
+            if (r > 1 && nearest * nearest > best2)
+            {
+                break;
+            }
+            visited += r == 0 ? 1 : 8 * r;
+            if (visited > scanCost)
+            {
+                return Scan(p, distance);
+            }
+            for (int64_t dx = -r; dx <= r; ++dx)
+            {
+                for (int64_t dy = -r; dy <= r; ++dy)
+                {
+                    if (std::max(std::abs(dx), std::abs(dy)) != r)
+                    {
+                        continue; // interior, visited in an earlier ring
+                    }
+                    auto it = m_cells.find(Key(cx + dx, cy + dy));
+                    if (it == m_cells.end())
+                    {
+                        continue;
+                    }
+                    for (uint32_t i : it->second)
+                    {
+                        double ddx = m_rsus[i].x - p.x;
+                        double ddy = m_rsus[i].y - p.y;
+                        double d2 = ddx * ddx + ddy * ddy;
+                        if (d2 < best2)
+                        {
+                            best2 = d2;
+                            best = i;
+                        }
+                    }
+                }
+            }
+        }
+        distance = std::sqrt(best2);
+        return best;
+    }
+
+    const Vector& GetPosition(uint32_t rsu) const
+    {
+        return m_rsus[rsu];
+    }
+
+  private:
+    uint32_t Scan(const Vector& p, double& distance) const
+    {
+        uint32_t best = 0;
+        double best2 = std::numeric_limits<double>::infinity();
+        for (uint32_t i = 0; i < m_rsus.size(); ++i)
+        {
+            double dx = m_rsus[i].x - p.x;
+            double dy = m_rsus[i].y - p.y;
+            double d2 = dx * dx + dy * dy;
+            if (d2 < best2)
+            {
+                best2 = d2;
+                best = i;
+            }
+        }
+        distance = std::sqrt(best2);
+        return best;
+    }
+
+    int64_t CellOf(double v) const
+    {
+        return static_cast<int64_t>(std::floor(v / m_cellSize));
+    }
+
+    static uint64_t Key(int64_t cx, int64_t cy)
+    {
+        return (static_cast<uint64_t>(cx) << 32) ^ static_cast<uint32_t>(cy);
+    }
+
+    std::vector<Vector> m_rsus;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+    double m_cellSize{1.0};
+    int64_t m_minCx{0};
+    int64_t m_maxCx{0};
+    int64_t m_minCy{0};
+    int64_t m_maxCy{0};
+};
+
+class V2xAssociationManager : public SimpleRefCount<V2xAssociationManager>
+{
+  public:
+    /// Called on handover with (vehicle index, old RSU, new RSU).
+    typedef std::function<void(uint32_t, uint32_t, uint32_t)> HandoverCallback;
+
+    void SetRsus(const std::vector<Vector>& positions)
+    {
+        m_index.Build(positions);
+        m_handoversIn.assign(positions.size(), 0);
+    }
+
+    void SetHysteresis(double meters)
+    {
+        m_hysteresis = meters;
+    }
+
+    void SetHandoverCallback(HandoverCallback cb)
+    {
+        m_handover = std::move(cb);
+    }
+
+    /// Read vehicle positions from `store`; call before Initialize().
+    void SetPositionStore(Ptr<V2xPositionStore> store)
+    {
+        m_store = store;
+    }
+
+    /// Associate every vehicle with its nearest RSU (no callbacks).
+    void Initialize(const NodeContainer& vehicles)
+    {
+        Attach(vehicles);
+        for (uint32_t i = 0; i < vehicles.GetN(); ++i)
+        {
+            double d;
+            m_rsu[i] = m_index.Nearest(PositionOf(i, Simulator::Now().GetTimeStep()), d);
+        }
+    }
+
+    /// As Initialize(), with the initial associations given (snapshot restore).
+    void Initialize(const NodeContainer& vehicles, const std::vector<uint32_t>& rsu)
+    {
+        NS_ABORT_MSG_IF(rsu.size() != vehicles.GetN(), "Association: one RSU per vehicle expected");
+        Attach(vehicles);
+        for (uint32_t i = 0; i < vehicles.GetN(); ++i)
+        {
+            NS_ABORT_MSG_IF(rsu[i] >= m_handoversIn.size(), "Association: unknown RSU " << rsu[i]);
+            m_rsu[i] = rsu[i];
+        }
+    }
+
+    /// Re-evaluate all associations every `interval` (zero: never).
+    void Start(Time interval)
+    {
+        m_interval = interval;
+        if (m_interval.IsStrictlyPositive())
+        {
+            m_event = Simulator::Schedule(m_interval, &V2xAssociationManager::Update, this);
+        }
+    }
+
+    void Stop()
+    {
+        m_event.Cancel();
+    }
+
+    uint32_t GetRsu(uint32_t vehicle) const
+    {
+        return m_rsu[vehicle];
+    }
+
+    uint32_t GetNRsus() const
+    {
+        return static_cast<uint32_t>(m_handoversIn.size());
+    }
+
+    uint64_t GetHandovers() const
+    {
+        return m_handovers;
+    }
+
+    uint64_t GetHandoversIn(uint32_t rsu) const
+    {
+        return m_handoversIn[rsu];
+    }
+
+    /// Vehicles currently associated with each RSU.
+    std::vector<uint32_t> GetLoad() const
+    {
+        std::vector<uint32_t> load(GetNRsus(), 0);
+        for (uint32_t r : m_rsu)
+        {
+            ++load[r];
+        }
+        return load;
+    }
+
+  private:
+    void Attach(const NodeContainer& vehicles)
+    {
+        m_mobility.resize(vehicles.GetN());
+        m_slot.assign(vehicles.GetN(), V2xPositionStore::NONE);
+        m_rsu.resize(vehicles.GetN());
+        for (uint32_t i = 0; i < vehicles.GetN(); ++i)
+        {
+            m_mobility[i] = vehicles.Get(i)->GetObject<MobilityModel>();
+            NS_ABORT_MSG_IF(!m_mobility[i], "Association needs a mobility model on every vehicle");
+            if (m_store)
+            {
+                m_slot[i] = m_store->SlotOf(vehicles.Get(i)->GetId());
+            }
+        }
+    }
+
+    Vector PositionOf(uint32_t i, int64_t now) const
+    {
+        return m_slot[i] != V2xPositionStore::NONE ? m_store->Get(m_slot[i], now)
+                                                   : m_mobility[i]->GetPosition();
+    }
+
+    void Update()
+    {
+        const int64_t now = Simulator::Now().GetTimeStep();
+        for (uint32_t i = 0; i < m_mobility.size(); ++i)
+        {
+            const Vector p = PositionOf(i, now);
+            double d;
+            uint32_t best = m_index.Nearest(p, d);
+            uint32_t cur = m_rsu[i];
+            if (best == cur || CalculateDistance(p, m_index.GetPosition(cur)) - d <= m_hysteresis)
+            {
+                continue;
+            }
+            m_rsu[i] = best;
+            ++m_handovers;
+            ++m_handoversIn[best];
+            if (m_handover)
+            {
+                m_handover(i, cur, best);
+            }
+        }
+        m_event = Simulator::Schedule(m_interval, &V2xAssociationManager::Update, this);
+    }
+
+    V2xRsuIndex m_index;
+    std::vector<Ptr<MobilityModel>> m_mobility;
+    std::vector<uint32_t> m_slot; //!< position store slot per vehicle
+    Ptr<V2xPositionStore> m_store;
+    std::vector<uint32_t> m_rsu;
+    std::vector<uint64_t> m_handoversIn;
+    HandoverCallback m_handover;
+    double m_hysteresis{5.0};
+    Time m_interval;
+    EventId m_event;
+    uint64_t m_handovers{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_ASSOCIATION_H */
@@ -0,0 +1,386 @@
+/* v2x-beacon-apps.h
+ *
+ * RSU beaconing and vehicle reaction, as described in the README.
+ * - RsuBeaconApplication<N>: UDP broadcast of an N-byte beacon every
+ *   Interval
+ * - VehicleClientApplication<N>: waits for the first beacon, then sends a
+ *   small probe, an N-byte DATA packet after ProbeGap, an optional
+ *   redundant DATA after RedundantDelay and, if DataInterval is non-zero,
+ *   periodic DATA from then on; with VehicleIndex set, every DATA packet
+ *   starts with a V2xStampHeader (the payload size stays N bytes)
+ *
+ * Beacons, probes and DATA carry a SocketPriorityTag (Priority,
+ * ProbePriority, DataPriority) that puts them in the beacon, DENM and bulk
+ * classes of V2xPriorityQueueDisc.
+ *
+ * Both senders take their packet from the shared V2xPayloads() templates
+ * once and send copies of it (V2xPayloads().Copy(), which counts them):
+ * the payload buffer is shared by every application and only the Packet
+ * wrapper is created per send. The send EventId is kept and rescheduled
+ * from the send handler itself, so there is exactly one pending event per
+ * application.
+ */
+
+#ifndef V2X_BEACON_APPS_H
+#define V2X_BEACON_APPS_H
+
+#include "ns3/abort.h"
+#include "ns3/application.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/traced-callback.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include "v2x-payload.h"
+#include "v2x-stamp-header.h"
+#include "v2x-traits.h"
+
+#include <string>
+
+namespace ns3
+{
+
+template <uint32_t PayloadSize>
+class RsuBeaconApplication : public Application
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::RsuBeaconApplication<" + std::to_string(PayloadSize) + ">")
+                .SetParent<Application>()
+                .SetGroupName("Applications")
+                .AddConstructor<RsuBeaconApplication>()
+                .AddAttribute("Interval",
+                              "Beacon period",
+                              TimeValue(MilliSeconds(100)),
+                              MakeTimeAccessor(&RsuBeaconApplication::m_interval),
+                              MakeTimeChecker())
+                .AddAttribute("Destination",
+                              "Beacon destination (broadcast) address",
+                              Ipv4AddressValue(Ipv4Address::GetBroadcast()),
+                              MakeIpv4AddressAccessor(&RsuBeaconApplication::m_destination),
+                              MakeIpv4AddressChecker())
+                .AddAttribute("Port",
+                              "Beacon destination port",
+                              UintegerValue(5001),
+                              MakeUintegerAccessor(&RsuBeaconApplication::m_port),
+                              MakeUintegerChecker<uint16_t>())
+                .AddAttribute("Priority",
+                              "Socket priority of the beacons (6 = AC_VO, the beacon class)",
+                              UintegerValue(6),
+                              MakeUintegerAccessor(&RsuBeaconApplication::m_priority),
+                              MakeUintegerChecker<uint8_t>(0, 7))
+                .AddTraceSource("Tx",
+                                "A beacon is sent",
+                                MakeTraceSourceAccessor(&RsuBeaconApplication::m_txTrace),
+                                "ns3::Packet::AddressTracedCallback");
+        return tid;
+    }
+
+    uint64_t GetBeaconsSent() const
+    {
+        return m_sent;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_socket = nullptr;
+        m_beacon = nullptr;
+        Application::DoDispose();
+    }
+
+  private:
+    void StartApplication() override
+    {
+        if (!m_socket)
+        {
+            m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            m_socket->SetAllowBroadcast(true);
+            m_socket->Bind();
+        }
+        if (!m_beacon)
+        {
+            m_beacon = V2xPayloads().Get(PayloadSize);
+            SocketPriorityTag tag;
+            tag.SetPriority(m_priority);
+            m_beacon->AddPacketTag(tag);
+        }
+        m_dstAddress = InetSocketAddress(m_destination, m_port);
+        m_sendEvent = Simulator::ScheduleNow(&RsuBeaconApplication::SendBeacon, this);
+    }
+
+    void StopApplication() override
+    {
+        m_sendEvent.Cancel();
+    }
+
+    void SendBeacon()
+    {
+        Ptr<Packet> p = V2xPayloads().Copy(m_beacon);
+        m_socket->SendTo(p, 0, m_dstAddress);
+        m_txTrace(p, m_dstAddress);
+        ++m_sent;
+        m_sendEvent = Simulator::Schedule(m_interval, &RsuBeaconApplication::SendBeacon, this);
+    }
+
+    Time m_interval;
+    Ipv4Address m_destination;
+    uint16_t m_port{5001};
+    uint8_t m_priority{6};
+    Address m_dstAddress;
+    Ptr<Socket> m_socket;
+    Ptr<Packet> m_beacon;
+    EventId m_sendEvent;
+    uint64_t m_sent{0};
+    TracedCallback<Ptr<const Packet>, const Address&> m_txTrace;
+};
+
+template <uint32_t PayloadSize>
+class VehicleClientApplication : public Application
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::VehicleClientApplication<" + std::to_string(PayloadSize) + ">")
+                .SetParent<Application>()
+                .SetGroupName("Applications")
+                .AddConstructor<VehicleClientApplication>()
+                .AddAttribute("BeaconPort",
+                              "Port the RSU beacons arrive on",
+                              UintegerValue(5001),
+                              MakeUintegerAccessor(&VehicleClientApplication::m_beaconPort),
+                              MakeUintegerChecker<uint16_t>())
+                .AddAttribute("Remote",
+                              "RSU address DATA is sent to",
+                              Ipv4AddressValue(),
+                              MakeIpv4AddressAccessor(&VehicleClientApplication::SetRemote,
+                                                      &VehicleClientApplication::GetRemote),
+                              MakeIpv4AddressChecker())
+                .AddAttribute("RemotePort",
+                              "RSU DATA port",
+                              UintegerValue(5000),
+                              MakeUintegerAccessor(&VehicleClientApplication::m_remotePort),
+                              MakeUintegerChecker<uint16_t>())
+                .AddAttribute("ProbeSize",
+                              "Size of the probe sent on the first beacon (bytes)",
+                              UintegerValue(28),
+                              MakeUintegerAccessor(&VehicleClientApplication::m_probeSize),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("ProbeGap",
+                              "Delay between the probe and the first DATA packet",
+                              TimeValue(MilliSeconds(10)),
+                              MakeTimeAccessor(&VehicleClientApplication::m_probeGap),
+                              MakeTimeChecker())
+                .AddAttribute("RedundantDelay",
+                              "Delay of the redundant DATA packet, 0 to disable",
+                              TimeValue(Seconds(1)),
+                              MakeTimeAccessor(&VehicleClientApplication::m_redundantDelay),
+                              MakeTimeChecker())
+                .AddAttribute("DataInterval",
+                              "Period of DATA after the reaction, 0 for none",
+                              TimeValue(Seconds(0)),
+                              MakeTimeAccessor(&VehicleClientApplication::m_dataInterval),
+                              MakeTimeChecker())
+                .AddAttribute("VehicleIndex",
+                              "Index stamped into DATA packets, UINT32_MAX for no stamp",
+                              UintegerValue(UINT32_MAX),
+                              MakeUintegerAccessor(&VehicleClientApplication::m_vehicleIndex),
+                              MakeUintegerChecker<uint32_t>())
+                .AddAttribute("ProbePriority",
+                              "Socket priority of the probe (5 = AC_VI, the DENM class)",
+                              UintegerValue(5),
+                              MakeUintegerAccessor(&VehicleClientApplication::m_probePriority),
+                              MakeUintegerChecker<uint8_t>(0, 7))
+                .AddAttribute("DataPriority",
+                              "Socket priority of DATA (0 = AC_BE, the bulk class)",
+                              UintegerValue(0),
+                              MakeUintegerAccessor(&VehicleClientApplication::m_dataPriority),
+                              MakeUintegerChecker<uint8_t>(0, 7))
+                .AddTraceSource("Tx",
+                                "A probe or DATA packet is sent",
+                                MakeTraceSourceAccessor(&VehicleClientApplication::m_txTrace),
+                                "ns3::Packet::AddressTracedCallback");
+        return tid;
+    }
+
+    bool HasReacted() const
+    {
+        return m_reacted;
+    }
+
+    /// Retarget DATA, also while running (RSU handover).
+    void SetRemote(Ipv4Address remote)
+    {
+        m_remote = remote;
+        m_dstAddress = InetSocketAddress(m_remote, m_remotePort);
+    }
+
+    Ipv4Address GetRemote() const
+    {
+        return m_remote;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_rxSocket = nullptr;
+        m_txSocket = nullptr;
+        m_data = nullptr;
+        m_probe = nullptr;
+        Application::DoDispose();
+    }
+
+  private:
+    void StartApplication() override
+    {
+        if (!m_rxSocket)
+        {
+            m_rxSocket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            m_rxSocket->SetAllowBroadcast(true);
+            m_rxSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_beaconPort));
+            m_txSocket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            m_txSocket->Bind();
+        }
+        m_rxSocket->SetRecvCallback(MakeCallback(&VehicleClientApplication::HandleBeacon, this));
+        if (!m_data)
+        {
+            m_data = V2xPayloads().Get(IsStamped() ? PayloadSize - V2xStampHeader::SIZE : PayloadSize);
+            m_probe = V2xPayloads().Get(m_probeSize);
+            SocketPriorityTag tag;
+            tag.SetPriority(m_dataPriority);
+            m_data->AddPacketTag(tag);
+            tag.SetPriority(m_probePriority);
+            m_probe->AddPacketTag(tag);
+        }
+        m_dstAddress = InetSocketAddress(m_remote, m_remotePort);
+    }
+
+    void StopApplication() override
+    {
+        m_sendEvent.Cancel();
+        m_redundantEvent.Cancel();
+        if (m_rxSocket)
+        {
+            m_rxSocket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        }
+    }
+
+    void HandleBeacon(Ptr<Socket> socket)
+    {
+        Ptr<Packet> packet;
+        while ((packet = socket->Recv()))
+        {
+        }
+        if (m_reacted)
+        {
+            return;
+        }
+        m_reacted = true;
+        Send(V2xPayloads().Copy(m_probe));
+        m_sendEvent = Simulator::Schedule(m_probeGap, &VehicleClientApplication::SendData, this);
+        if (!m_redundantDelay.IsZero())
+        {
+            m_redundantEvent = Simulator::Schedule(m_probeGap + m_redundantDelay,
+                                                   &VehicleClientApplication::SendRedundant,
+                                                   this);
+        }
+    }
+
+    bool IsStamped() const
+    {
+        return V2xScenarioTraits::METRICS && m_vehicleIndex != UINT32_MAX;
+    }
+
+    void SendData()
+    {
+        SendDataPacket();
+        if (!m_dataInterval.IsZero())
+        {
+            m_sendEvent =
+                Simulator::Schedule(m_dataInterval, &VehicleClientApplication::SendData, this);
+        }
+    }
+
+    void SendRedundant()
+    {
+        SendDataPacket();
+    }
+
+    void SendDataPacket()
+    {
+        Ptr<Packet> p = V2xPayloads().Copy(m_data);
+        if (IsStamped())
+        {
+            V2xStampHeader stamp;
+            stamp.Set(m_vehicleIndex, m_seq++, Simulator::Now().GetNanoSeconds());
+            p->AddHeader(stamp);
+        }
+        Send(p);
+    }
+
+    void Send(Ptr<Packet> p)
+    {
+        m_txSocket->SendTo(p, 0, m_dstAddress);
+        m_txTrace(p, m_dstAddress);
+    }
+
+    uint16_t m_beaconPort{5001};
+    Ipv4Address m_remote;
+    uint16_t m_remotePort{5000};
+    uint32_t m_probeSize{28};
+    Time m_probeGap;
+    Time m_redundantDelay;
+    Time m_dataInterval;
+    uint32_t m_vehicleIndex{UINT32_MAX};
+    uint8_t m_probePriority{5};
+    uint8_t m_dataPriority{0};
+    uint32_t m_seq{0};
+    Address m_dstAddress;
+    Ptr<Socket> m_rxSocket;
+    Ptr<Socket> m_txSocket;
+    Ptr<Packet> m_data;
+    Ptr<Packet> m_probe;
+    EventId m_sendEvent;
+    EventId m_redundantEvent;
+    bool m_reacted{false};
+    TracedCallback<Ptr<const Packet>, const Address&> m_txTrace;
+};
+
+/// Instantiate App<N> for one of the supported payload sizes.
+template <template <uint32_t> class App>
+Ptr<Application>
+CreateSizedApplication(uint32_t payloadSize)
+{
+    switch (payloadSize)
+    {
+    case 64:
+        return CreateObject<App<64>>();
+    case 100:
+        return CreateObject<App<100>>();
+    case 200:
+        return CreateObject<App<200>>();
+    case 300:
+        return CreateObject<App<300>>();
+    case 500:
+        return CreateObject<App<500>>();
+    case 1000:
+        return CreateObject<App<1000>>();
+    default:
+        NS_FATAL_ERROR("Unsupported payload size " << payloadSize
+                                                   << " (64|100|200|300|500|1000)");
+    }
+    return nullptr;
+}
+
+} // namespace ns3
+
+#endif /* V2X_BEACON_APPS_H */
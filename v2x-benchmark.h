@@ -0,0 +1,242 @@
+/* v2x-benchmark.h
+ *
+ * Fixed benchmark matrix (--benchmark) on top of the sweep process pool.
+ * - nVehicles 10, 100, 1000, 10000 x beacon rate 1, 5, 10, 20 Hz x tracing
+ *   none, pcap, ascii, flowmon, queue, all; --benchmarkMaxVehicles trims
+ *   the vehicle axis for quick runs, nothing else is configurable so a
+ *   baseline stays comparable with later ones
+ * - Every point runs the beacon traffic mode: RSU beacons and vehicle DATA
+ *   both at the point's rate; simTime, topology and access layer are the
+ *   base configuration's
+ * - "none" turns every tracing subsystem off (PCAP, ASCII, binary PHY
+ *   trace, FlowMonitor, queue statistics, event log); each other variant
+ *   turns one back on, "all" turns them all on, so the cost of a subsystem
+ *   is its run time over the "none" run at the same point
+ * - Runs one process at a time by default (--benchmarkJobs) so runs do not
+ *   compete for cores and memory bandwidth
+ *
+ * Output: <benchmarkOutput>.csv (one row per run) and <benchmarkOutput>.json
+ * (the same runs plus the mean slowdown of each tracing variant). txPackets
+ * and pdr cover vehicle probes and DATA only; RSU beacons are counted
+ * apart in beaconPackets.
+ */
+
+#ifndef V2X_BENCHMARK_H
+#define V2X_BENCHMARK_H
+
+#include "ns3/abort.h"
+
+#include "v2x-scenario.h"
+#include "v2x-sweep.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+struct V2xBenchmarkSpec
+{
+    uint32_t maxVehicles = 10000; //!< drop matrix points above this
+    uint32_t jobs = 1;            //!< concurrent processes
+    std::string output = "v2x-benchmark";
+};
+
+class V2xBenchmark
+{
+  public:
+    struct Point
+    {
+        uint32_t nVehicles;
+        double rateHz;
+        std::string tracing;
+    };
+
+    static const std::vector<uint32_t>& Vehicles()
+    {
+        static const std::vector<uint32_t> v{10, 100, 1000, 10000};
+        return v;
+    }
+
+    static const std::vector<double>& Rates()
+    {
+        static const std::vector<double> v{1, 5, 10, 20};
+        return v;
+    }
+
+    static const std::vector<std::string>& Tracing()
+    {
+        static const std::vector<std::string> v{"none", "pcap", "ascii", "flowmon", "queue", "all"};
+        return v;
+    }
+
+    /// The matrix on top of `base`; points[i] describes configs[i].
+    static std::vector<ScenarioConfig> Expand(const ScenarioConfig& base,
+                                              const V2xBenchmarkSpec& spec,
+                                              std::vector<Point>& points)
+    {
+        std::vector<ScenarioConfig> configs;
+        points.clear();
+        for (uint32_t n : Vehicles())
+        {
+            if (n > spec.maxVehicles)
+            {
+                continue;
+            }
+            for (double rate : Rates())
+            {
+                for (const std::string& tracing : Tracing())
+                {
+                    ScenarioConfig cfg = base;
+                    cfg.nVehicles = n;
+                    cfg.trafficMode = "beacon";
+                    cfg.beaconInterval = 1.0 / rate;
+                    cfg.dataInterval = 1.0 / rate;
+                    ApplyTracing(cfg, tracing);
+                    cfg.profile = false;
+                    cfg.snapshotSave.clear();
+                    cfg.snapshotLoad.clear();
+                    cfg.outputPrefix = spec.output + "-" + std::to_string(configs.size());
+                    configs.push_back(cfg);
+                    points.push_back({n, rate, tracing});
+                }
+            }
+        }
+        NS_ABORT_MSG_IF(configs.empty(), "--benchmarkMaxVehicles leaves no benchmark points");
+        return configs;
+    }
+
+    /// Run the matrix and write the baseline; returns the number of failed runs.
+    static uint32_t Run(const ScenarioConfig& base, const V2xBenchmarkSpec& spec)
+    {
+        std::vector<Point> points;
+        std::vector<ScenarioConfig> configs = Expand(base, spec, points);
+        std::vector<ScenarioResult> results;
+        std::vector<bool> ok;
+        std::cout << "Benchmark: " << configs.size() << " points\n";
+        V2xSweepRunner::Execute(configs, spec.jobs, results, ok);
+
+        uint32_t failed = 0;
+        for (bool b : ok)
+        {
+            failed += b ? 0 : 1;
+        }
+        WriteCsv(spec.output + ".csv", configs, points, results, ok);
+        WriteJson(spec.output + ".json", configs, points, results, ok);
+        std::cout << "Benchmark: baseline in " << spec.output << ".csv/.json (" << failed
+                  << " failed)\n";
+        return failed;
+    }
+
+  private:
+    static void ApplyTracing(ScenarioConfig& cfg, const std::string& tracing)
+    {
+        const bool all = tracing == "all";
+        cfg.enablePcap = all || tracing == "pcap";
+        cfg.asciiTrace = all || tracing == "ascii";
+        cfg.phyTrace = all && V2xScenarioTraits::PHY_TRACE;
+        cfg.enableFlowMonitor = all || tracing == "flowmon";
+        cfg.resultsFormat = cfg.enableFlowMonitor ? "xml" : "none";
+        cfg.enableQueueTraces = all || tracing == "queue";
+        cfg.enableNetAnim = false;
+        cfg.logLevel = all ? cfg.logLevel : V2xEventLog::LEVEL_OFF;
+    }
+
+    static double SimToReal(const ScenarioConfig& cfg, const ScenarioResult& r)
+    {
+        return r.runSeconds > 0 ? cfg.simTime / r.runSeconds : 0.0;
+    }
+
+    static double EventsPerSecond(const ScenarioResult& r)
+    {
+        return r.runSeconds > 0 ? r.events / r.runSeconds : 0.0;
+    }
+
+    static void WriteCsv(const std::string& fileName,
+                         const std::vector<ScenarioConfig>& configs,
+                         const std::vector<Point>& points,
+                         const std::vector<ScenarioResult>& results,
+                         const std::vector<bool>& ok)
+    {
+        std::ofstream os(fileName);
+        NS_ABORT_MSG_IF(!os.is_open(), "Cannot open benchmark output " << fileName);
+        os << "run,nVehicles,rateHz,tracing,simTime,events,wallSeconds,runSeconds,"
+              "eventsPerSecond,simToReal,peakRssKb,txPackets,rxPackets,beaconPackets,pdr,status\n";
+        for (size_t i = 0; i < configs.size(); ++i)
+        {
+            const ScenarioResult& r = results[i];
+            os << i << ',' << points[i].nVehicles << ',' << points[i].rateHz << ','
+               << points[i].tracing << ',' << configs[i].simTime << ',' << r.events << ','
+               << r.wallSeconds << ',' << r.runSeconds << ',' << EventsPerSecond(r) << ','
+               << SimToReal(configs[i], r) << ',' << r.peakRssKb << ',' << r.txPackets << ','
+               << r.rxPackets << ',' << r.beaconPackets << ',' << r.GetPdr() << ','
+               << (ok[i] ? "ok" : "failed") << '\n';
+        }
+    }
+
+    static void WriteJson(const std::string& fileName,
+                          const std::vector<ScenarioConfig>& configs,
+                          const std::vector<Point>& points,
+                          const std::vector<ScenarioResult>& results,
+                          const std::vector<bool>& ok)
+    {
+        std::ofstream os(fileName);
+        NS_ABORT_MSG_IF(!os.is_open(), "Cannot open benchmark output " << fileName);
+        os << "{\n  \"runs\": [";
+        for (size_t i = 0; i < configs.size(); ++i)
+        {
+            const ScenarioResult& r = results[i];
+            os << (i ? ",\n" : "\n") << "    {\"nVehicles\": " << points[i].nVehicles
+               << ", \"rateHz\": " << points[i].rateHz << ", \"tracing\": \"" << points[i].tracing
+               << "\", \"simTime\": " << configs[i].simTime << ", \"events\": " << r.events
+               << ", \"wallSeconds\": " << r.wallSeconds << ", \"runSeconds\": " << r.runSeconds
+               << ", \"eventsPerSecond\": " << EventsPerSecond(r)
+               << ", \"simToReal\": " << SimToReal(configs[i], r)
+               << ", \"peakRssKb\": " << r.peakRssKb << ", \"txPackets\": " << r.txPackets
+               << ", \"rxPackets\": " << r.rxPackets << ", \"beaconPackets\": " << r.beaconPackets
+               << ", \"pdr\": " << r.GetPdr() << ", \"ok\": " << (ok[i] ? "true" : "false")
+               << "}";
+        }
+
+        // Run time of each tracing variant over "none" at the same (nVehicles, rate),
+        // averaged over the points where both runs succeeded.
+        os << "\n  ],\n  \"tracingSlowdown\": {";
+        bool first = true;
+        for (const std::string& tracing : Tracing())
+        {
+            if (tracing == "none")
+            {
+                continue;
+            }
+            double sum = 0;
+            uint32_t n = 0;
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                if (points[i].tracing != tracing || !ok[i])
+                {
+                    continue;
+                }
+                for (size_t j = 0; j < points.size(); ++j)
+                {
+                    if (points[j].tracing == "none" && ok[j] &&
+                        points[j].nVehicles == points[i].nVehicles &&
+                        points[j].rateHz == points[i].rateHz && results[j].runSeconds > 0)
+                    {
+                        sum += results[i].runSeconds / results[j].runSeconds;
+                        ++n;
+                    }
+                }
+            }
+            os << (first ? "\n" : ",\n") << "    \"" << tracing << "\": " << (n ? sum / n : 0.0);
+            first = false;
+        }
+        os << "\n  }\n}\n";
+    }
+};
+
+} // namespace ns3
+
+#endif /* V2X_BENCHMARK_H */
@@ -0,0 +1,118 @@
+/* v2x-busy-time.h
+ *
+ * Per-device Wi-Fi channel busy time, the CBR input of V2xDcc and
+ * V2xOnlineStats.
+ * - Busy is any PHY state but IDLE/SLEEP/OFF, taken from the
+ *   WifiPhyStateHelper "State" trace
+ * - The trace reports RX, CCA_BUSY and the other states when they end,
+ *   but TX when it starts, with its full duration: a report can cover time
+ *   before the current window (already charged by the window close) or
+ *   after the present (a TX still on the air)
+ * - Take() closes a device's window at `now`: a reported busy interval
+ *   past `now` is carried over into the next window, and a state still
+ *   running but not reported yet is split at `now`
+ *
+ * One meter per owner; the owner calls Take() for each of its devices at
+ * a window end, then SetWindowStart() once.
+ */
+
+#ifndef V2X_BUSY_TIME_H
+#define V2X_BUSY_TIME_H
+
+#include "ns3/nstime.h"
+#include "ns3/wifi-phy-state-helper.h"
+#include "ns3/wifi-phy.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xBusyTimeMeter
+{
+  public:
+    static bool IsBusy(WifiPhyState state)
+    {
+        return state != WifiPhyState::IDLE && state != WifiPhyState::SLEEP &&
+               state != WifiPhyState::OFF;
+    }
+
+    /// Devices 0..n-1, none attached.
+    void Resize(uint32_t n)
+    {
+        m_state.assign(n, nullptr);
+        m_busyNs.assign(n, 0);
+        m_reportedTo.assign(n, 0);
+    }
+
+    /// Meters device i from `phy`; the meter must not move afterwards.
+    void Attach(uint32_t i, Ptr<WifiPhy> phy)
+    {
+        m_state[i] = phy->GetState();
+        m_state[i]->TraceConnectWithoutContext(
+            "State",
+            MakeBoundCallback(&V2xBusyTimeMeter::StateSink, this, i));
+    }
+
+    bool IsAttached(uint32_t i) const
+    {
+        return m_state[i] != nullptr;
+    }
+
+    void SetWindowStart(Time start)
+    {
+        m_windowStart = start.GetTimeStep();
+    }
+
+    /// Busy ns of device i between the window start and `now`.
+    int64_t Take(uint32_t i, Time now)
+    {
+        const int64_t t = now.GetTimeStep();
+        int64_t busy = m_busyNs[i];
+        int64_t carry = 0;
+        if (m_reportedTo[i] > t)
+        {
+            // a TX on the air: reported whole, its tail belongs to the next window
+            carry = m_reportedTo[i] - t;
+        }
+        else if (IsBusy(m_state[i]->GetState()))
+        {
+            // a busy state still running: its part up to now belongs here
+            busy += t - std::max(m_reportedTo[i], m_windowStart);
+        }
+        m_busyNs[i] = carry;
+        return busy - carry;
+    }
+
+  private:
+    /// The part before the window start was charged to the previous window by Take().
+    static void StateSink(V2xBusyTimeMeter* meter,
+                          uint32_t i,
+                          Time start,
+                          Time duration,
+                          WifiPhyState state)
+    {
+        const int64_t to = (start + duration).GetTimeStep();
+        meter->m_reportedTo[i] = std::max(meter->m_reportedTo[i], to);
+        if (!IsBusy(state))
+        {
+            return;
+        }
+        const int64_t from = std::max(start.GetTimeStep(), meter->m_windowStart);
+        if (to > from)
+        {
+            meter->m_busyNs[i] += to - from;
+        }
+    }
+
+    std::vector<Ptr<WifiPhyStateHelper>> m_state;
+    std::vector<int64_t> m_busyNs;     //!< charged to the current window so far
+    std::vector<int64_t> m_reportedTo; //!< end of the latest reported state
+    int64_t m_windowStart{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_BUSY_TIME_H */
@@ -0,0 +1,313 @@
+/* v2x-columnar.h
+ *
+ * Memory-mapped columnar results file, replacing the FlowMonitor XML dump.
+ * - Tables are declared up front (schema + row count), the file is sized
+ *   once and mapped, and rows are written straight into their columns, so
+ *   end-of-run cost is one pass over the flows/nodes and no in-memory tree
+ * - Readers mmap the file and index columns directly, no parsing; Open()
+ *   checks every table and column entry against the file size first, so a
+ *   truncated or corrupt file aborts instead of reading out of bounds
+ *
+ * Layout (little-endian host order, all offsets from the start of file,
+ * every column 8-byte aligned):
+ *
+ *   FileHeader   magic "V2XCOL01", uint32 version = 1, uint32 nTables
+ *   TableEntry   nTables x { char name[24]; uint64 nRows; uint32 nColumns;
+ *                             uint32 pad; uint64 columnsOffset }
+ *   per table:
+ *     ColumnEntry  nColumns x { char name[24]; uint32 type; uint32 width;
+ *                                uint64 dataOffset }
+ *     column data  nColumns x nRows values of `width` bytes each
+ *
+ * Column types: 0 = uint32, 1 = uint64, 2 = int64, 3 = double.
+ */
+
+#ifndef V2X_COLUMNAR_H
+#define V2X_COLUMNAR_H
+
+#include "ns3/abort.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+namespace v2xcol
+{
+
+enum ColumnType : uint32_t
+{
+    U32 = 0,
+    U64 = 1,
+    I64 = 2,
+    F64 = 3,
+};
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t nTables;
+};
+
+struct TableEntry
+{
+    char name[24];
+    uint64_t nRows;
+    uint32_t nColumns;
+    uint32_t pad;
+    uint64_t columnsOffset;
+};
+
+struct ColumnEntry
+{
+    char name[24];
+    uint32_t type;
+    uint32_t width;
+    uint64_t dataOffset;
+};
+
+inline uint32_t
+Width(ColumnType type)
+{
+    return type == U32 ? 4 : 8;
+}
+
+inline uint64_t
+Align8(uint64_t x)
+{
+    return (x + 7) & ~uint64_t(7);
+}
+
+} // namespace v2xcol
+
+class V2xColumnarWriter
+{
+  public:
+    struct Column
+    {
+        std::string name;
+        v2xcol::ColumnType type;
+    };
+
+    ~V2xColumnarWriter()
+    {
+        Close();
+    }
+
+    /// Declare a table before Open(); returns its index.
+    uint32_t AddTable(const std::string& name, uint64_t nRows, const std::vector<Column>& columns)
+    {
+        NS_ABORT_MSG_IF(m_base, "Columnar tables must be declared before Open()");
+        NS_ABORT_MSG_IF(name.size() >= sizeof(v2xcol::TableEntry::name),
+                        "Columnar table name too long: " << name);
+        m_tables.push_back({name, nRows, columns, {}});
+        return static_cast<uint32_t>(m_tables.size() - 1);
+    }
+
+    /// Lay out every declared table, size the file and map it.
+    void Open(const std::string& fileName)
+    {
+        using namespace v2xcol;
+        uint64_t offset = Align8(sizeof(FileHeader) + m_tables.size() * sizeof(TableEntry));
+        std::vector<uint64_t> columnsOffset(m_tables.size());
+        for (size_t t = 0; t < m_tables.size(); ++t)
+        {
+            Table& table = m_tables[t];
+            columnsOffset[t] = offset;
+            offset = Align8(offset + table.columns.size() * sizeof(ColumnEntry));
+            table.data.resize(table.columns.size());
+            for (size_t c = 0; c < table.columns.size(); ++c)
+            {
+                NS_ABORT_MSG_IF(table.columns[c].name.size() >= sizeof(ColumnEntry::name),
+                                "Columnar column name too long: " << table.columns[c].name);
+                table.data[c] = offset;
+                offset = Align8(offset + table.nRows * Width(table.columns[c].type));
+            }
+        }
+        m_size = offset;
+
+        m_fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        NS_ABORT_MSG_IF(m_fd < 0, "Cannot open columnar file " << fileName);
+        NS_ABORT_MSG_IF(ftruncate(m_fd, static_cast<off_t>(m_size)) != 0,
+                        "Cannot size columnar file " << fileName);
+        void* base = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        NS_ABORT_MSG_IF(base == MAP_FAILED, "Cannot map columnar file " << fileName);
+        m_base = static_cast<uint8_t*>(base);
+
+        FileHeader* header = reinterpret_cast<FileHeader*>(m_base);
+        std::memcpy(header->magic, "V2XCOL01", 8);
+        header->version = 1;
+        header->nTables = static_cast<uint32_t>(m_tables.size());
+        TableEntry* entries = reinterpret_cast<TableEntry*>(m_base + sizeof(FileHeader));
+        for (size_t t = 0; t < m_tables.size(); ++t)
+        {
+            const Table& table = m_tables[t];
+            std::strncpy(entries[t].name, table.name.c_str(), sizeof(entries[t].name) - 1);
+            entries[t].nRows = table.nRows;
+            entries[t].nColumns = static_cast<uint32_t>(table.columns.size());
+            entries[t].columnsOffset = columnsOffset[t];
+            ColumnEntry* cols = reinterpret_cast<ColumnEntry*>(m_base + columnsOffset[t]);
+            for (size_t c = 0; c < table.columns.size(); ++c)
+            {
+                std::strncpy(cols[c].name, table.columns[c].name.c_str(), sizeof(cols[c].name) - 1);
+                cols[c].type = table.columns[c].type;
+                cols[c].width = Width(table.columns[c].type);
+                cols[c].dataOffset = table.data[c];
+            }
+        }
+    }
+
+    /// Store one value; T must match the column's type.
+    template <typename T>
+    void Set(uint32_t table, uint32_t column, uint64_t row, T value)
+    {
+        const Table& t = m_tables[table];
+        NS_ASSERT_MSG(row < t.nRows && column < t.columns.size(), "Columnar index out of range");
+        NS_ASSERT_MSG(sizeof(T) == v2xcol::Width(t.columns[column].type),
+                      "Columnar value width does not match column " << t.columns[column].name);
+        std::memcpy(m_base + t.data[column] + row * sizeof(T), &value, sizeof(T));
+    }
+
+    void Close()
+    {
+        if (m_base)
+        {
+            msync(m_base, m_size, MS_ASYNC);
+            munmap(m_base, m_size);
+            m_base = nullptr;
+        }
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    uint64_t GetSize() const
+    {
+        return m_size;
+    }
+
+  private:
+    struct Table
+    {
+        std::string name;
+        uint64_t nRows;
+        std::vector<Column> columns;
+        std::vector<uint64_t> data; //!< file offset of each column
+    };
+
+    std::vector<Table> m_tables;
+    int m_fd{-1};
+    uint8_t* m_base{nullptr};
+    uint64_t m_size{0};
+};
+
+/// Read-only mapping of a V2XCOL01 file.
+class V2xColumnarReader
+{
+  public:
+    ~V2xColumnarReader()
+    {
+        if (m_base)
+        {
+            munmap(const_cast<uint8_t*>(m_base), m_size);
+        }
+    }
+
+    void Open(const std::string& fileName)
+    {
+        int fd = open(fileName.c_str(), O_RDONLY);
+        NS_ABORT_MSG_IF(fd < 0, "Cannot open columnar file " << fileName);
+        struct stat st;
+        NS_ABORT_MSG_IF(fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(v2xcol::FileHeader)),
+                        fileName << " is too short for a columnar file");
+        m_size = static_cast<uint64_t>(st.st_size);
+        void* base = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        NS_ABORT_MSG_IF(base == MAP_FAILED, "Cannot map columnar file " << fileName);
+        m_base = static_cast<const uint8_t*>(base);
+        NS_ABORT_MSG_IF(std::memcmp(GetHeader().magic, "V2XCOL01", 8) != 0,
+                        fileName << " is not a V2XCOL01 file");
+        Validate(fileName);
+    }
+
+    const v2xcol::FileHeader& GetHeader() const
+    {
+        return *reinterpret_cast<const v2xcol::FileHeader*>(m_base);
+    }
+
+    const v2xcol::TableEntry& GetTable(uint32_t t) const
+    {
+        return reinterpret_cast<const v2xcol::TableEntry*>(m_base + sizeof(v2xcol::FileHeader))[t];
+    }
+
+    const v2xcol::ColumnEntry& GetColumn(uint32_t t, uint32_t c) const
+    {
+        return reinterpret_cast<const v2xcol::ColumnEntry*>(m_base + GetTable(t).columnsOffset)[c];
+    }
+
+    template <typename T>
+    const T* GetData(uint32_t t, uint32_t c) const
+    {
+        return reinterpret_cast<const T*>(m_base + GetColumn(t, c).dataOffset);
+    }
+
+  private:
+    /// True if `count` items of `width` bytes at `offset` lie inside the file.
+    bool Fits(uint64_t offset, uint64_t count, uint64_t width) const
+    {
+        return offset <= m_size && count <= (m_size - offset) / width;
+    }
+
+    /// Every entry and column in bounds, aligned and well-formed.
+    void Validate(const std::string& fileName) const
+    {
+        using namespace v2xcol;
+        const FileHeader& header = GetHeader();
+        NS_ABORT_MSG_IF(header.version != 1,
+                        fileName << ": unsupported columnar version " << header.version);
+        NS_ABORT_MSG_IF(!Fits(sizeof(FileHeader), header.nTables, sizeof(TableEntry)),
+                        fileName << ": table directory runs past the end of the file");
+        for (uint32_t t = 0; t < header.nTables; ++t)
+        {
+            const TableEntry& table = GetTable(t);
+            NS_ABORT_MSG_IF(!std::memchr(table.name, 0, sizeof(table.name)),
+                            fileName << ": table " << t << " has an unterminated name");
+            NS_ABORT_MSG_IF(table.columnsOffset % 8 != 0 ||
+                                !Fits(table.columnsOffset, table.nColumns, sizeof(ColumnEntry)),
+                            fileName << ": column directory of table " << table.name
+                                     << " is misaligned or past the end of the file");
+            for (uint32_t c = 0; c < table.nColumns; ++c)
+            {
+                const ColumnEntry& column = GetColumn(t, c);
+                NS_ABORT_MSG_IF(!std::memchr(column.name, 0, sizeof(column.name)),
+                                fileName << ": column " << c << " of table " << table.name
+                                         << " has an unterminated name");
+                NS_ABORT_MSG_IF(column.type > F64 ||
+                                    column.width != Width(static_cast<ColumnType>(column.type)),
+                                fileName << ": column " << column.name << " of table "
+                                         << table.name << " has a bad type or width");
+                NS_ABORT_MSG_IF(column.dataOffset % 8 != 0 ||
+                                    !Fits(column.dataOffset, table.nRows, column.width),
+                                fileName << ": data of column " << column.name << " of table "
+                                         << table.name << " is misaligned or truncated");
+            }
+        }
+    }
+
+    const uint8_t* m_base{nullptr};
+    uint64_t m_size{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_COLUMNAR_H */
@@ -0,0 +1,336 @@
+/* v2x-dcc.h
+ *
+ * Decentralized Congestion Control (--dcc), after ETSI TS 102 687.
+ * - Channel busy ratio (CBR) per vehicle: Wi-Fi from V2xBusyTimeMeter
+ *   (time not IDLE/SLEEP/OFF over the last period), sidelink from the
+ *   device's own subchannel CBR; smoothed as CBR = (CBR + measured) / 2
+ * - reactive: five states (relaxed, active 1-3, restrictive) entered one
+ *   step per evaluation; each scales the send interval (x1, 2, 4, 5, 10,
+ *   the 100/200/400/500/1000 ms Toff ladder relative to the configured
+ *   rate), lowers TX power by 3 dB per state and raises the Wi-Fi data
+ *   rate (6, 6, 9, 12, 18 Mbps OFDM, 10 or 20 MHz as configured)
+ * - limeric: linear adaptive duty cycle
+ *       d <- (1 - alpha) d + clamp(beta (CBR_target - CBR_G), Gmin, Gmax)
+ *   with CBR_G the mean of the last two CBRs, d in [dmin, dmax], and the
+ *   send interval = max(frame airtime, configured interval x dmax) / d:
+ *   dmax maps to the configured rate (or the frame's own duty limit if
+ *   that is tighter), so the duty cycle binds at any --sendInterval;
+ *   TX power and rate stay unchanged
+ *
+ * Per-vehicle state lives in flat arrays and is updated from one periodic
+ * event for all vehicles; actuators are only touched when a value changes.
+ * The interval is never shorter than the configured one and never more
+ * than ten times longer.
+ */
+
+#ifndef V2X_DCC_H
+#define V2X_DCC_H
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-remote-station-manager.h"
+
+#include "v2x-busy-time.h"
+#include "v2x-sidelink.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xDcc : public SimpleRefCount<V2xDcc>
+{
+  public:
+    enum Algorithm : uint8_t
+    {
+        REACTIVE = 0,
+        LIMERIC
+    };
+
+    static constexpr uint32_t N_STATES = 5;
+
+    /// Applies a new send interval to vehicle `i`.
+    typedef std::function<void(uint32_t i, Time interval)> IntervalCallback;
+
+    V2xDcc(Algorithm algorithm, Time period, Time baseInterval)
+        : m_algorithm(algorithm),
+          m_period(period),
+          m_baseInterval(baseInterval)
+    {
+        NS_ABORT_MSG_IF(!period.IsStrictlyPositive(), "DCC needs a positive evaluation period");
+        NS_ABORT_MSG_IF(!baseInterval.IsStrictlyPositive(), "DCC needs a positive send interval");
+    }
+
+    static Algorithm Parse(const std::string& name)
+    {
+        if (name == "reactive")
+        {
+            return REACTIVE;
+        }
+        if (name == "limeric")
+        {
+            return LIMERIC;
+        }
+        NS_FATAL_ERROR("Unknown dcc '" << name << "' (off|reactive|limeric)");
+        return REACTIVE;
+    }
+
+    void SetIntervalCallback(IntervalCallback cb)
+    {
+        m_setInterval = std::move(cb);
+    }
+
+    /// Airtime of one vehicle frame, for the LIMERIC duty cycle.
+    void SetFrameAirtime(Time airtime)
+    {
+        m_airtime = airtime;
+    }
+
+    /// One device per vehicle, in vehicle order: the one carrying its DATA.
+    void SetDevices(const std::vector<Ptr<NetDevice>>& devices)
+    {
+        const uint32_t n = static_cast<uint32_t>(devices.size());
+        m_devices = devices;
+        m_wifi.assign(n, nullptr);
+        m_sidelink.assign(n, nullptr);
+        m_busy.Resize(n);
+        m_cbr.assign(n, 0.0f);
+        m_cbrPrev.assign(n, 0.0f);
+        m_state.assign(n, 0);
+        m_duty.assign(n, float(DUTY_MAX));
+        m_intervalNs.assign(n, m_baseInterval.GetTimeStep());
+        m_basePowerDbm.assign(n, 0.0f);
+        m_rateLadder.assign(n, nullptr);
+        m_stateTicks.assign(N_STATES, 0);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (Ptr<WifiNetDevice> wd = DynamicCast<WifiNetDevice>(devices[i]))
+            {
+                m_wifi[i] = PeekPointer(wd);
+                Ptr<WifiPhy> phy = wd->GetPhy();
+                m_basePowerDbm[i] = static_cast<float>(phy->GetTxPowerStart());
+                m_rateLadder[i] = phy->GetChannelWidth() == 10 ? RATES_10MHZ : RATES_20MHZ;
+                m_busy.Attach(i, phy);
+            }
+            else if (Ptr<V2xSidelinkNetDevice> sd = DynamicCast<V2xSidelinkNetDevice>(devices[i]))
+            {
+                m_sidelink[i] = PeekPointer(sd);
+                m_basePowerDbm[i] = static_cast<float>(sd->GetTxPowerDbm());
+            }
+            else
+            {
+                NS_FATAL_ERROR("DCC: vehicle " << i << " has neither a Wi-Fi nor a sidelink device");
+            }
+        }
+    }
+
+    /// First evaluation one period after `start`.
+    void Start(Time start)
+    {
+        m_windowStart = start;
+        m_busy.SetWindowStart(start);
+        Simulator::Schedule(start + m_period - Simulator::Now(), &V2xDcc::Tick, this);
+    }
+
+    double GetMeanCbr() const
+    {
+        return m_cbrSamples ? m_cbrSum / m_cbrSamples : 0.0;
+    }
+
+    uint64_t GetIntervalChanges() const
+    {
+        return m_intervalChanges;
+    }
+
+    void PrintStats(std::ostream& os) const
+    {
+        os << "DCC " << (m_algorithm == REACTIVE ? "reactive" : "limeric") << ": mean CBR "
+           << GetMeanCbr() << ", " << m_intervalChanges << " interval changes";
+        if (m_algorithm == REACTIVE)
+        {
+            uint64_t total = 0;
+            for (uint64_t t : m_stateTicks)
+            {
+                total += t;
+            }
+            os << ", state occupancy";
+            for (uint32_t s = 0; s < N_STATES; ++s)
+            {
+                os << ' ' << (total ? double(m_stateTicks[s]) / total : 0.0);
+            }
+        }
+        os << '\n';
+    }
+
+  private:
+    // TS 102 687 LIMERIC parameters
+    static constexpr double ALPHA = 0.016;
+    static constexpr double BETA = 0.0012;
+    static constexpr double CBR_TARGET = 0.68;
+    static constexpr double G_MAX = 0.0005;
+    static constexpr double G_MIN = -0.00025;
+    static constexpr double DUTY_MIN = 0.0006;
+    static constexpr double DUTY_MAX = 0.03;
+    static constexpr uint32_t MAX_SLOWDOWN = 10;
+
+    static constexpr const char* RATES_10MHZ[N_STATES] = {"OfdmRate6MbpsBW10MHz",
+                                                          "OfdmRate6MbpsBW10MHz",
+                                                          "OfdmRate9MbpsBW10MHz",
+                                                          "OfdmRate12MbpsBW10MHz",
+                                                          "OfdmRate18MbpsBW10MHz"};
+    static constexpr const char* RATES_20MHZ[N_STATES] = {"OfdmRate6Mbps",
+                                                          "OfdmRate6Mbps",
+                                                          "OfdmRate9Mbps",
+                                                          "OfdmRate12Mbps",
+                                                          "OfdmRate18Mbps"};
+
+    /// CBR upper bound of each reactive state but the last.
+    static double StateCeiling(uint32_t s)
+    {
+        static const double ceiling[N_STATES - 1] = {0.30, 0.40, 0.50, 0.60};
+        return ceiling[s];
+    }
+
+    static uint32_t StateSlowdown(uint32_t s)
+    {
+        static const uint32_t slowdown[N_STATES] = {1, 2, 4, 5, 10};
+        return slowdown[s];
+    }
+
+    void Tick()
+    {
+        const Time now = Simulator::Now();
+        const double window = static_cast<double>((now - m_windowStart).GetTimeStep());
+        for (uint32_t i = 0; i < m_devices.size(); ++i)
+        {
+            double measured;
+            if (m_wifi[i])
+            {
+                const double busy = static_cast<double>(m_busy.Take(i, now));
+                measured = window > 0 ? std::min(1.0, busy / window) : 0.0;
+            }
+            else
+            {
+                measured = m_sidelink[i]->GetChannelBusyRatio();
+            }
+            m_cbrPrev[i] = m_cbr[i];
+            m_cbr[i] = static_cast<float>(0.5 * (m_cbr[i] + measured));
+            m_cbrSum += m_cbr[i];
+            ++m_cbrSamples;
+            if (m_algorithm == REACTIVE)
+            {
+                UpdateReactive(i);
+            }
+            else
+            {
+                UpdateLimeric(i);
+            }
+        }
+        m_windowStart = now;
+        m_busy.SetWindowStart(now);
+        Simulator::Schedule(m_period, &V2xDcc::Tick, this);
+    }
+
+    void UpdateReactive(uint32_t i)
+    {
+        uint32_t s = m_state[i];
+        if (s + 1 < N_STATES && m_cbr[i] >= StateCeiling(s))
+        {
+            ++s;
+        }
+        else if (s > 0 && m_cbr[i] < StateCeiling(s - 1))
+        {
+            --s;
+        }
+        ++m_stateTicks[s];
+        if (s == m_state[i])
+        {
+            return;
+        }
+        m_state[i] = static_cast<uint8_t>(s);
+        ApplyInterval(i, m_baseInterval.GetTimeStep() * StateSlowdown(s));
+        const double power = m_basePowerDbm[i] - 3.0 * s;
+        if (m_wifi[i])
+        {
+            Ptr<WifiPhy> phy = m_wifi[i]->GetPhy();
+            phy->SetTxPowerStart(power);
+            phy->SetTxPowerEnd(power);
+            m_wifi[i]->GetRemoteStationManager()->SetAttribute("DataMode",
+                                                               StringValue(m_rateLadder[i][s]));
+        }
+        else
+        {
+            m_sidelink[i]->SetAttribute("TxPower", DoubleValue(power));
+        }
+    }
+
+    void UpdateLimeric(uint32_t i)
+    {
+        const double cbrG = 0.5 * (m_cbr[i] + m_cbrPrev[i]);
+        const double offset = std::clamp(BETA * (CBR_TARGET - cbrG), G_MIN, G_MAX);
+        const double duty = std::clamp((1.0 - ALPHA) * m_duty[i] + offset, DUTY_MIN, DUTY_MAX);
+        m_duty[i] = static_cast<float>(duty);
+        // DUTY_MAX is the configured rate, unless the frame airtime needs a longer one
+        const double reference =
+            std::max<double>(m_airtime.GetTimeStep(), m_baseInterval.GetTimeStep() * DUTY_MAX);
+        ApplyInterval(i, static_cast<int64_t>(reference / duty));
+    }
+
+    void ApplyInterval(uint32_t i, int64_t intervalNs)
+    {
+        const int64_t base = m_baseInterval.GetTimeStep();
+        intervalNs = std::clamp<int64_t>(intervalNs, base, base * MAX_SLOWDOWN);
+        // ignore sub-percent LIMERIC drift
+        if (std::abs(intervalNs - m_intervalNs[i]) * 100 < m_intervalNs[i])
+        {
+            return;
+        }
+        m_intervalNs[i] = intervalNs;
+        ++m_intervalChanges;
+        if (m_setInterval)
+        {
+            m_setInterval(i, TimeStep(intervalNs));
+        }
+    }
+
+    Algorithm m_algorithm;
+    Time m_period;
+    Time m_baseInterval;
+    Time m_airtime{MicroSeconds(300)};
+    Time m_windowStart;
+    IntervalCallback m_setInterval;
+
+    std::vector<Ptr<NetDevice>> m_devices;
+    std::vector<WifiNetDevice*> m_wifi;
+    std::vector<V2xSidelinkNetDevice*> m_sidelink;
+    V2xBusyTimeMeter m_busy;
+    std::vector<float> m_cbr;
+    std::vector<float> m_cbrPrev;
+    std::vector<uint8_t> m_state;
+    std::vector<float> m_duty;
+    std::vector<int64_t> m_intervalNs;
+    std::vector<float> m_basePowerDbm;
+    std::vector<const char* const*> m_rateLadder;
+
+    std::vector<uint64_t> m_stateTicks;
+    double m_cbrSum{0};
+    uint64_t m_cbrSamples{0};
+    uint64_t m_intervalChanges{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_DCC_H */
@@ -0,0 +1,239 @@
+/* v2x-event-log.h
+ *
+ * Buffered event log for the V2X scenario.
+ * - Fixed-size records collected in a preallocated block, written out in
+ *   one go when the block fills up or when the log is closed
+ * - Compact CSV or raw binary records
+ * - Level and 1-in-N sampling (per event type) checks are inline, so a
+ *   disabled log costs a single compare in the hot callbacks
+ *
+ * Binary layout: 8-byte magic "V2XEVT01", uint32 record size, then packed
+ * V2xEventRecord structs in host byte order.
+ */
+
+#ifndef V2X_EVENT_LOG_H
+#define V2X_EVENT_LOG_H
+
+#include "ns3/abort.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Preallocated block of fixed-size records that is flushed to a file in a
+ * single write when full. Record must provide
+ * `static void WriteCsvHeader(std::ostream&)` and
+ * `void WriteCsv(std::ostream&) const`.
+ */
+template <typename Record>
+class V2xRecordBuffer
+{
+  public:
+    ~V2xRecordBuffer()
+    {
+        Close();
+    }
+
+    void Open(const std::string& fileName, bool binary, const char* magic, size_t capacity)
+    {
+        Close();
+        m_binary = binary;
+        m_records.resize(capacity > 0 ? capacity : 1);
+        m_count = 0;
+        m_os.open(fileName, binary ? std::ios::out | std::ios::binary : std::ios::out);
+        NS_ABORT_MSG_IF(!m_os.is_open(), "Cannot open record file " << fileName);
+        if (m_binary)
+        {
+            uint32_t recordSize = sizeof(Record);
+            m_os.write(magic, 8);
+            m_os.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize));
+        }
+        else
+        {
+            Record::WriteCsvHeader(m_os);
+        }
+    }
+
+    bool IsOpen() const
+    {
+        return m_os.is_open();
+    }
+
+    void Push(const Record& record)
+    {
+        m_records[m_count++] = record;
+        if (m_count == m_records.size())
+        {
+            Flush();
+        }
+    }
+
+    void Flush()
+    {
+        if (!m_os.is_open() || m_count == 0)
+        {
+            return;
+        }
+        if (m_binary)
+        {
+            m_os.write(reinterpret_cast<const char*>(m_records.data()),
+                       static_cast<std::streamsize>(m_count * sizeof(Record)));
+        }
+        else
+        {
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                m_records[i].WriteCsv(m_os);
+            }
+        }
+        m_count = 0;
+    }
+
+    void Close()
+    {
+        if (m_os.is_open())
+        {
+            Flush();
+            m_os.close();
+        }
+    }
+
+  private:
+    std::vector<Record> m_records;
+    size_t m_count{0};
+    bool m_binary{false};
+    std::ofstream m_os;
+};
+
+/// One application or queue event, 24 bytes.
+struct V2xEventRecord
+{
+    int64_t timeNs; //!< simulation time
+    uint32_t node;  //!< node the event happened on
+    uint32_t size;  //!< packet size in bytes
+    uint32_t peer;  //!< remote IPv4 address (host order), 0 if none
+    uint16_t port;  //!< remote port, 0 if none
+    uint8_t type;   //!< V2xEventLog::Event
+    uint8_t pad;
+
+    static void WriteCsvHeader(std::ostream& os)
+    {
+        os << "time_ns,event,node,size,peer,port\n";
+    }
+
+    void WriteCsv(std::ostream& os) const
+    {
+        static const char* const names[] = {"tx", "rx", "enq", "deq", "drop"};
+        os << timeNs << ',' << (type < 5 ? names[type] : "?") << ',' << node << ',' << size
+           << ',' << ((peer >> 24) & 0xff) << '.' << ((peer >> 16) & 0xff) << '.'
+           << ((peer >> 8) & 0xff) << '.' << (peer & 0xff) << ',' << port << '\n';
+    }
+};
+
+/**
+ * Scenario event log. Callers guard each record with ShouldLog() so that
+ * nothing but the level compare runs when logging is off.
+ */
+class V2xEventLog
+{
+  public:
+    enum Level : uint8_t
+    {
+        LEVEL_OFF = 0,   //!< nothing recorded
+        LEVEL_APP = 1,   //!< application TX/RX
+        LEVEL_QUEUE = 2, //!< plus queue enqueue/dequeue/drop
+    };
+
+    enum Event : uint8_t
+    {
+        EVENT_TX = 0,
+        EVENT_RX,
+        EVENT_ENQUEUE,
+        EVENT_DEQUEUE,
+        EVENT_DROP,
+    };
+
+    static constexpr size_t N_EVENTS = EVENT_DROP + 1;
+
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    void Configure(uint32_t level,
+                   uint32_t sampleRate,
+                   const std::string& fileName,
+                   bool binary,
+                   size_t capacity = DEFAULT_CAPACITY)
+    {
+        m_level = static_cast<uint8_t>(level > LEVEL_QUEUE ? uint32_t(LEVEL_QUEUE) : level);
+        m_sampleRate = sampleRate > 0 ? sampleRate : 1;
+        m_sampleCounter.fill(0);
+        if (m_level != LEVEL_OFF)
+        {
+            m_buffer.Open(fileName, binary, "V2XEVT01", capacity);
+        }
+    }
+
+    /// True if an event of this level and type should be recorded (applies
+    /// sampling, 1 in N of each type).
+    bool ShouldLog(Level level, Event type)
+    {
+        if (m_level < level)
+        {
+            return false;
+        }
+        if (m_sampleRate == 1)
+        {
+            return true;
+        }
+        uint32_t& counter = m_sampleCounter[type];
+        if (++counter < m_sampleRate)
+        {
+            return false;
+        }
+        counter = 0;
+        return true;
+    }
+
+    void Record(int64_t timeNs,
+                Event type,
+                uint32_t node,
+                uint32_t size,
+                uint32_t peer = 0,
+                uint16_t port = 0)
+    {
+        V2xEventRecord r;
+        r.timeNs = timeNs;
+        r.node = node;
+        r.size = size;
+        r.peer = peer;
+        r.port = port;
+        r.type = type;
+        r.pad = 0;
+        m_buffer.Push(r);
+    }
+
+    void Flush()
+    {
+        m_buffer.Flush();
+    }
+
+    void Close()
+    {
+        m_buffer.Close();
+    }
+
+  private:
+    uint8_t m_level{LEVEL_OFF};
+    uint32_t m_sampleRate{1};
+    std::array<uint32_t, N_EVENTS> m_sampleCounter{};
+    V2xRecordBuffer<V2xEventRecord> m_buffer;
+};
+
+} // namespace ns3
+
+#endif /* V2X_EVENT_LOG_H */
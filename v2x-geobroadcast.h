@@ -0,0 +1,532 @@
+/* v2x-geobroadcast.h
+ *
+ * V2V broadcast with geo-scoped multi-hop forwarding (--v2vInterval).
+ * - V2xGeoHeader (36 bytes): source node, sequence number, hop count and
+ *   limit, the last sender's position and the destination area (circle
+ *   around the originator)
+ * - V2xDuplicateRing: the last N (source, seq) keys of a node in a fixed
+ *   ring, so duplicate detection costs the same memory at any density and
+ *   old entries simply age out; slots with a pending relay are skipped
+ *   when the ring wraps, and an open-addressed key -> slot index makes
+ *   lookups O(1)
+ * - V2xGeoBroadcastApplication: originates a broadcast every Interval and
+ *   relays first-heard messages inside the area with a contention timer
+ *   that is shorter the farther the node is from the last sender (plus a
+ *   small random jitter, so nodes beyond ContentionRange do not all fire
+ *   at once); hearing the same message again before the timer fires
+ *   cancels the relay (suppression), so normally one relay per hop
+ *   rebroadcasts
+ *
+ * Pending relays live in the duplicate ring next to their key: at most N
+ * per node, whatever the storm, and never more than one per message.
+ * That holds while N covers the distinct messages a node hears during
+ * the time copies of one keep arriving, about
+ *   neighbours x originate rate x MaxHops x ContentionMax
+ * (256 covers 170 neighbours at 10 Hz, 3 hops, 50 ms). Below that, keys
+ * age out early and later copies count as fresh again; if every slot
+ * holds a pending relay, the oldest is cancelled and counted in
+ * GetEvictedRelays().
+ */
+
+#ifndef V2X_GEOBROADCAST_H
+#define V2X_GEOBROADCAST_H
+
+#include "ns3/abort.h"
+#include "ns3/application.h"
+#include "ns3/double.h"
+#include "ns3/header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include "v2x-payload.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xGeoHeader : public Header
+{
+  public:
+    static constexpr uint32_t MAGIC = 0x56325847; // "V2XG"
+    static constexpr uint32_t SIZE = 36;
+
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::V2xGeoHeader")
+                                .SetParent<Header>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<V2xGeoHeader>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return SIZE;
+    }
+
+    void Serialize(Buffer::Iterator start) const override
+    {
+        start.WriteHtonU32(MAGIC);
+        start.WriteHtonU32(source);
+        start.WriteHtonU32(seq);
+        start.WriteU8(hops);
+        start.WriteU8(maxHops);
+        start.WriteU16(0);
+        for (float v : {senderX, senderY, centerX, centerY, radius})
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &v, 4);
+            start.WriteHtonU32(bits);
+        }
+    }
+
+    uint32_t Deserialize(Buffer::Iterator start) override
+    {
+        m_magic = start.ReadNtohU32();
+        source = start.ReadNtohU32();
+        seq = start.ReadNtohU32();
+        hops = start.ReadU8();
+        maxHops = start.ReadU8();
+        start.ReadU16();
+        for (float* v : {&senderX, &senderY, &centerX, &centerY, &radius})
+        {
+            const uint32_t bits = start.ReadNtohU32();
+            std::memcpy(v, &bits, 4);
+        }
+        return SIZE;
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "source=" << source << " seq=" << seq << " hops=" << unsigned(hops) << "/"
+           << unsigned(maxHops) << " area=(" << centerX << "," << centerY << ") r=" << radius;
+    }
+
+    /// True if `p` starts with a geo header; fills `hdr` from it.
+    static bool Peek(Ptr<const Packet> p, V2xGeoHeader& hdr)
+    {
+        return p->GetSize() >= SIZE && p->PeekHeader(hdr) == SIZE && hdr.m_magic == MAGIC;
+    }
+
+    uint64_t GetKey() const
+    {
+        return (uint64_t(source) << 32) | seq;
+    }
+
+    uint32_t source{0};
+    uint32_t seq{0};
+    uint8_t hops{0};
+    uint8_t maxHops{0};
+    float senderX{0};
+    float senderY{0};
+    float centerX{0};
+    float centerY{0};
+    float radius{0};
+
+  private:
+    uint32_t m_magic{MAGIC};
+};
+
+NS_OBJECT_ENSURE_REGISTERED(V2xGeoHeader);
+
+/// Fixed-size ring of recently seen message keys, with a pending relay per slot.
+class V2xDuplicateRing
+{
+  public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    void Resize(uint32_t slots)
+    {
+        NS_ABORT_MSG_IF(slots == 0, "V2xDuplicateRing needs at least one slot");
+        m_keys.assign(slots, EMPTY);
+        m_relay.assign(slots, EventId());
+        m_next = 0;
+        // open-addressed key -> slot index, at most half full
+        uint32_t size = 2;
+        m_indexBits = 1;
+        while (size < 2 * slots)
+        {
+            size <<= 1;
+            ++m_indexBits;
+        }
+        m_index.assign(size, NOT_FOUND);
+    }
+
+    uint32_t Find(uint64_t key) const
+    {
+        const uint32_t mask = static_cast<uint32_t>(m_index.size()) - 1;
+        for (uint32_t p = Home(key);; p = (p + 1) & mask)
+        {
+            const uint32_t slot = m_index[p];
+            if (slot == NOT_FOUND || m_keys[slot] == key)
+            {
+                return slot;
+            }
+        }
+    }
+
+    /**
+     * Record `key` (not in the ring yet) over the oldest entry without a
+     * pending relay; returns its slot. The skip over pending slots is
+     * amortized O(1) while at most about half of them hold a relay.
+     */
+    uint32_t Insert(uint64_t key)
+    {
+        const uint32_t n = static_cast<uint32_t>(m_keys.size());
+        uint32_t slot = m_next;
+        for (uint32_t k = 0; k < n && m_relay[slot].IsRunning(); ++k)
+        {
+            slot = (slot + 1) % n;
+        }
+        if (m_relay[slot].IsRunning())
+        {
+            m_relay[slot].Cancel(); // every slot is pending: the ring is too small
+            ++m_evicted;
+        }
+        if (m_keys[slot] != EMPTY)
+        {
+            Unindex(m_keys[slot]);
+        }
+        m_keys[slot] = key;
+        m_relay[slot] = EventId();
+        const uint32_t mask = static_cast<uint32_t>(m_index.size()) - 1;
+        uint32_t p = Home(key);
+        while (m_index[p] != NOT_FOUND)
+        {
+            p = (p + 1) & mask;
+        }
+        m_index[p] = slot;
+        m_next = (slot + 1) % n;
+        return slot;
+    }
+
+    EventId& Relay(uint32_t slot)
+    {
+        return m_relay[slot];
+    }
+
+    /// Pending relays cancelled because the ring was full of them.
+    uint64_t GetEvicted() const
+    {
+        return m_evicted;
+    }
+
+  private:
+    static constexpr uint64_t EMPTY = UINT64_MAX;
+
+    uint32_t Home(uint64_t key) const
+    {
+        // Fibonacci hashing: source and seq both live in the top bits
+        return static_cast<uint32_t>((key * 0x9e3779b97f4a7c15ULL) >> (64 - m_indexBits));
+    }
+
+    /// Drops `key` from the index, shifting its probe run back (no tombstones).
+    void Unindex(uint64_t key)
+    {
+        const uint32_t mask = static_cast<uint32_t>(m_index.size()) - 1;
+        uint32_t hole = Home(key);
+        while (m_keys[m_index[hole]] != key)
+        {
+            hole = (hole + 1) & mask;
+        }
+        for (uint32_t p = (hole + 1) & mask; m_index[p] != NOT_FOUND; p = (p + 1) & mask)
+        {
+            // an entry whose home lies cyclically in (hole, p] stays put
+            const uint32_t home = Home(m_keys[m_index[p]]);
+            const bool stays = hole < p ? (home > hole && home <= p) : (home > hole || home <= p);
+            if (!stays)
+            {
+                m_index[hole] = m_index[p];
+                hole = p;
+            }
+        }
+        m_index[hole] = NOT_FOUND;
+    }
+
+    std::vector<uint64_t> m_keys;
+    std::vector<EventId> m_relay;
+    std::vector<uint32_t> m_index; //!< slot of each key, by hash; NOT_FOUND = free
+    uint32_t m_indexBits{1};
+    uint32_t m_next{0};
+    uint64_t m_evicted{0};
+};
+
+class V2xGeoBroadcastApplication : public Application
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::V2xGeoBroadcastApplication")
+                .SetParent<Application>()
+                .SetGroupName("Applications")
+                .AddConstructor<V2xGeoBroadcastApplication>()
+                .AddAttribute("Interval",
+                              "Period of originated broadcasts, 0 to only relay",
+                              TimeValue(MilliSeconds(100)),
+                              MakeTimeAccessor(&V2xGeoBroadcastApplication::m_interval),
+                              MakeTimeChecker())
+                .AddAttribute("PayloadSize",
+                              "Payload after the geo header (bytes)",
+                              UintegerValue(200),
+                              MakeUintegerAccessor(&V2xGeoBroadcastApplication::m_payloadSize),
+                              MakeUintegerChecker<uint32_t>())
+                .AddAttribute("Destination",
+                              "Broadcast address of the V2V subnet",
+                              Ipv4AddressValue(Ipv4Address::GetBroadcast()),
+                              MakeIpv4AddressAccessor(&V2xGeoBroadcastApplication::m_destination),
+                              MakeIpv4AddressChecker())
+                .AddAttribute("Port",
+                              "V2V broadcast port",
+                              UintegerValue(5002),
+                              MakeUintegerAccessor(&V2xGeoBroadcastApplication::m_port),
+                              MakeUintegerChecker<uint16_t>())
+                .AddAttribute("MaxHops",
+                              "Hop limit of originated messages (1 = no relaying)",
+                              UintegerValue(3),
+                              MakeUintegerAccessor(&V2xGeoBroadcastApplication::m_maxHops),
+                              MakeUintegerChecker<uint8_t>(1))
+                .AddAttribute("AreaRadius",
+                              "Radius of the destination area around the originator (m)",
+                              DoubleValue(500),
+                              MakeDoubleAccessor(&V2xGeoBroadcastApplication::m_areaRadius),
+                              MakeDoubleChecker<double>(0))
+                .AddAttribute("ContentionMax",
+                              "Relay timer of a node next to the last sender",
+                              TimeValue(MilliSeconds(50)),
+                              MakeTimeAccessor(&V2xGeoBroadcastApplication::m_contentionMax),
+                              MakeTimeChecker())
+                .AddAttribute("ContentionRange",
+                              "Distance from the last sender at which the relay timer is zero (m)",
+                              DoubleValue(300),
+                              MakeDoubleAccessor(&V2xGeoBroadcastApplication::m_contentionRange),
+                              MakeDoubleChecker<double>(1))
+                .AddAttribute("ContentionJitter",
+                              "Upper bound of the uniform jitter added to every relay timer",
+                              TimeValue(MilliSeconds(2)),
+                              MakeTimeAccessor(&V2xGeoBroadcastApplication::m_contentionJitter),
+                              MakeTimeChecker())
+                .AddAttribute("DuplicateSlots",
+                              "Size of the duplicate ring (messages remembered)",
+                              UintegerValue(256),
+                              MakeUintegerAccessor(&V2xGeoBroadcastApplication::m_slots),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("Priority",
+                              "Socket priority (6 = AC_VO, the beacon class)",
+                              UintegerValue(6),
+                              MakeUintegerAccessor(&V2xGeoBroadcastApplication::m_priority),
+                              MakeUintegerChecker<uint8_t>(0, 7));
+        return tid;
+    }
+
+    uint64_t GetOriginated() const
+    {
+        return m_originated;
+    }
+
+    uint64_t GetReceived() const
+    {
+        return m_received;
+    }
+
+    uint64_t GetDuplicates() const
+    {
+        return m_duplicates;
+    }
+
+    uint64_t GetRelayed() const
+    {
+        return m_relayed;
+    }
+
+    uint64_t GetSuppressed() const
+    {
+        return m_suppressed;
+    }
+
+    uint64_t GetEvictedRelays() const
+    {
+        return m_ring.GetEvicted();
+    }
+
+    V2xGeoBroadcastApplication()
+    {
+        m_rng = CreateObject<UniformRandomVariable>();
+    }
+
+    int64_t AssignStreams(int64_t stream)
+    {
+        m_rng->SetStream(stream);
+        return 1;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_socket = nullptr;
+        m_payload = nullptr;
+        m_mobility = nullptr;
+        m_rng = nullptr;
+        Application::DoDispose();
+    }
+
+  private:
+    void StartApplication() override
+    {
+        if (!m_socket)
+        {
+            m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            m_socket->SetAllowBroadcast(true);
+            m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port));
+            m_mobility = GetNode()->GetObject<MobilityModel>();
+            NS_ABORT_MSG_IF(!m_mobility, "V2xGeoBroadcastApplication needs a mobility model");
+            m_ring.Resize(m_slots);
+        }
+        m_socket->SetRecvCallback(MakeCallback(&V2xGeoBroadcastApplication::HandleRead, this));
+        if (!m_payload)
+        {
+            m_payload = V2xPayloads().Get(m_payloadSize);
+            SocketPriorityTag tag;
+            tag.SetPriority(m_priority);
+            m_payload->AddPacketTag(tag);
+        }
+        m_dstAddress = InetSocketAddress(m_destination, m_port);
+        if (!m_interval.IsZero())
+        {
+            m_sendEvent = Simulator::ScheduleNow(&V2xGeoBroadcastApplication::Originate, this);
+        }
+    }
+
+    void StopApplication() override
+    {
+        m_sendEvent.Cancel();
+        if (m_socket)
+        {
+            m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        }
+    }
+
+    void Originate()
+    {
+        const Vector pos = m_mobility->GetPosition();
+        V2xGeoHeader hdr;
+        hdr.source = GetNode()->GetId();
+        hdr.seq = m_seq++;
+        hdr.maxHops = m_maxHops;
+        hdr.senderX = hdr.centerX = static_cast<float>(pos.x);
+        hdr.senderY = hdr.centerY = static_cast<float>(pos.y);
+        hdr.radius = static_cast<float>(m_areaRadius);
+        m_ring.Insert(hdr.GetKey());
+        Send(hdr, V2xPayloads().Copy(m_payload));
+        ++m_originated;
+        m_sendEvent = Simulator::Schedule(m_interval, &V2xGeoBroadcastApplication::Originate, this);
+    }
+
+    void HandleRead(Ptr<Socket> socket)
+    {
+        Ptr<Packet> packet;
+        while ((packet = socket->Recv()))
+        {
+            V2xGeoHeader hdr;
+            if (!V2xGeoHeader::Peek(packet, hdr))
+            {
+                continue;
+            }
+            const uint32_t slot = m_ring.Find(hdr.GetKey());
+            if (slot != V2xDuplicateRing::NOT_FOUND)
+            {
+                ++m_duplicates;
+                EventId& relay = m_ring.Relay(slot);
+                if (relay.IsRunning())
+                {
+                    relay.Cancel(); // a farther node relayed first
+                    ++m_suppressed;
+                }
+                continue;
+            }
+            const uint32_t fresh = m_ring.Insert(hdr.GetKey());
+            ++m_received;
+
+            const Vector pos = m_mobility->GetPosition();
+            if (hdr.hops + 1 >= hdr.maxHops ||
+                std::hypot(pos.x - hdr.centerX, pos.y - hdr.centerY) > hdr.radius)
+            {
+                continue;
+            }
+            const double d = std::hypot(pos.x - hdr.senderX, pos.y - hdr.senderY);
+            const Time wait =
+                Seconds(m_contentionMax.GetSeconds() * std::max(0.0, 1.0 - d / m_contentionRange) +
+                        m_rng->GetValue(0.0, m_contentionJitter.GetSeconds()));
+            packet->RemoveHeader(hdr);
+            m_ring.Relay(fresh) =
+                Simulator::Schedule(wait, &V2xGeoBroadcastApplication::Relay, this, hdr, packet);
+        }
+    }
+
+    void Relay(V2xGeoHeader hdr, Ptr<Packet> payload)
+    {
+        const Vector pos = m_mobility->GetPosition();
+        ++hdr.hops;
+        hdr.senderX = static_cast<float>(pos.x);
+        hdr.senderY = static_cast<float>(pos.y);
+        payload->RemoveAllPacketTags(); // the previous hop's, incl. its priority
+        SocketPriorityTag tag;
+        tag.SetPriority(m_priority);
+        payload->AddPacketTag(tag);
+        Send(hdr, payload);
+        ++m_relayed;
+    }
+
+    void Send(const V2xGeoHeader& hdr, Ptr<Packet> p)
+    {
+        p->AddHeader(hdr);
+        m_socket->SendTo(p, 0, m_dstAddress);
+    }
+
+    Time m_interval;
+    uint32_t m_payloadSize{200};
+    Ipv4Address m_destination;
+    uint16_t m_port{5002};
+    uint8_t m_maxHops{3};
+    double m_areaRadius{500};
+    Time m_contentionMax;
+    double m_contentionRange{300};
+    Time m_contentionJitter;
+    uint32_t m_slots{256};
+    uint8_t m_priority{6};
+    Address m_dstAddress;
+    Ptr<Socket> m_socket;
+    Ptr<Packet> m_payload;
+    Ptr<MobilityModel> m_mobility;
+    Ptr<UniformRandomVariable> m_rng;
+    V2xDuplicateRing m_ring;
+    EventId m_sendEvent;
+    uint32_t m_seq{0};
+    uint64_t m_originated{0};
+    uint64_t m_received{0};
+    uint64_t m_duplicates{0};
+    uint64_t m_relayed{0};
+    uint64_t m_suppressed{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_GEOBROADCAST_H */
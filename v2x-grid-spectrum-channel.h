@@ -0,0 +1,514 @@
+/* v2x-grid-spectrum-channel.h
+ *
+ * SpectrumChannel that keeps receivers in a uniform 2D grid and only
+ * evaluates propagation for receivers in the 3x3 cells around the sender.
+ * - Cell size = MaxRange + CellMargin, so anything within MaxRange of the
+ *   sender is found as long as it moved less than CellMargin since it was
+ *   last binned
+ * - Receivers are re-binned on CourseChange and, for models that move
+ *   without notifying, on a periodic UpdateInterval sweep
+ * - Receivers farther than MaxRange or with path loss above MaxLossDb
+ *   (the RX sensitivity cutoff) get no StartRx event at all
+ * - With a V2xPositionStore, positions come from the store (one mobility
+ *   evaluation per node per timestamp) and, if a distance loss function is
+ *   set, path loss and delay are computed from the squared distance without
+ *   going back to the mobility models; a batch loss function evaluates all
+ *   in-range receivers of a transmission in one call
+ *
+ * Used with SpectrumWifiPhy via --channelModel=grid. Only scalar
+ * PropagationLossModels are applied; spectrum/antenna loss models are not.
+ */
+
+#ifndef V2X_GRID_SPECTRUM_CHANNEL_H
+#define V2X_GRID_SPECTRUM_CHANNEL_H
+
+#include "ns3/double.h"
+#include "ns3/mobility-model.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simulator.h"
+#include "ns3/spectrum-channel.h"
+#include "ns3/spectrum-phy.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/spectrum-value.h"
+
+#include "v2x-position-store.h"
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class GridSpectrumChannel : public SpectrumChannel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::GridSpectrumChannel")
+                .SetParent<SpectrumChannel>()
+                .SetGroupName("Spectrum")
+                .AddConstructor<GridSpectrumChannel>()
+                .AddAttribute("MaxRange",
+                              "Receivers farther than this from the sender are skipped (m)",
+                              DoubleValue(250.0),
+                              MakeDoubleAccessor(&GridSpectrumChannel::m_maxRange),
+                              MakeDoubleChecker<double>(1.0))
+                .AddAttribute("CellMargin",
+                              "Extra cell size covering movement between re-binning (m)",
+                              DoubleValue(50.0),
+                              MakeDoubleAccessor(&GridSpectrumChannel::m_cellMargin),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("UpdateInterval",
+                              "Period of the re-binning sweep for silently moving nodes",
+                              TimeValue(Seconds(1.0)),
+                              MakeTimeAccessor(&GridSpectrumChannel::m_updateInterval),
+                              MakeTimeChecker());
+        return tid;
+    }
+
+    std::size_t GetNDevices() const override
+    {
+        return m_rx.size();
+    }
+
+    Ptr<NetDevice> GetDevice(std::size_t i) const override
+    {
+        return m_rx[i].phy->GetDevice();
+    }
+
+    void AddRx(Ptr<SpectrumPhy> phy) override
+    {
+        // device/node/mobility are usually not attached yet; bin lazily
+        m_rx.push_back({phy,
+                        nullptr,
+                        std::numeric_limits<uint32_t>::max(),
+                        V2xPositionStore::NONE,
+                        0,
+                        false});
+        m_pending = true;
+    }
+
+    void RemoveRx(Ptr<SpectrumPhy> phy) override
+    {
+        for (std::size_t i = 0; i < m_rx.size(); ++i)
+        {
+            if (m_rx[i].phy == phy)
+            {
+                m_rx.erase(m_rx.begin() + i);
+                if (!m_pending)
+                {
+                    Rebuild();
+                }
+                return;
+            }
+        }
+    }
+
+    void StartTx(Ptr<SpectrumSignalParameters> txParams) override
+    {
+        NS_ASSERT_MSG(txParams->txPhy, "NULL txPhy");
+        if (m_pending)
+        {
+            Rebuild();
+        }
+        Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility();
+        if (!txMobility)
+        {
+            Ptr<NetDevice> dev = txParams->txPhy->GetDevice();
+            txMobility = dev ? dev->GetNode()->GetObject<MobilityModel>() : nullptr;
+        }
+        Ptr<NetDevice> txDevice = txParams->txPhy->GetDevice();
+        uint32_t txNode = txDevice ? txDevice->GetNode()->GetId()
+                                   : std::numeric_limits<uint32_t>::max();
+        if (!txMobility)
+        {
+            for (std::size_t i = 0; i < m_rx.size(); ++i)
+            {
+                Deliver(txParams, nullptr, Vector(), txNode, V2xPositionStore::NONE, 0, m_rx[i]);
+            }
+            return;
+        }
+
+        const int64_t now = Simulator::Now().GetTimeStep();
+        const uint32_t txSlot = m_store ? m_store->SlotOf(txNode) : V2xPositionStore::NONE;
+        Vector txPos = txSlot != V2xPositionStore::NONE ? m_store->Get(txSlot, now)
+                                                        : txMobility->GetPosition();
+        int32_t cx = CellCoord(txPos.x);
+        int32_t cy = CellCoord(txPos.y);
+        for (int32_t dx = -1; dx <= 1; ++dx)
+        {
+            for (int32_t dy = -1; dy <= 1; ++dy)
+            {
+                auto it = m_cells.find(CellKey(cx + dx, cy + dy));
+                if (it == m_cells.end())
+                {
+                    continue;
+                }
+                for (uint32_t idx : it->second)
+                {
+                    Deliver(txParams, txMobility, txPos, txNode, txSlot, now, m_rx[idx]);
+                }
+            }
+        }
+        for (uint32_t idx : m_unplaced)
+        {
+            Deliver(txParams, txMobility, txPos, txNode, txSlot, now, m_rx[idx]);
+        }
+        DeliverBatch(txParams, txMobility);
+    }
+
+    /// Read node positions from `store` instead of the mobility models.
+    void SetPositionStore(Ptr<V2xPositionStore> store)
+    {
+        m_store = store;
+        m_pending = true;
+    }
+
+    /**
+     * Path loss (dB) as a function of squared distance (m^2), used instead of
+     * the PropagationLossModel when both ends are in the position store. It
+     * must agree with the loss model, which still serves the other nodes.
+     */
+    void SetDistanceLoss(std::function<double(double)> lossDb)
+    {
+        m_distanceLoss = std::move(lossDb);
+    }
+
+    /// Batch form of SetDistanceLoss: fn(d2[], lossDb[], n) is called once
+    /// per transmission with every in-range stored receiver.
+    void SetDistanceLossBatch(std::function<void(const double*, double*, size_t)> lossDb)
+    {
+        m_distanceLossBatch = std::move(lossDb);
+    }
+
+    /// Number of candidate receivers the last Rebuild() put in grid cells.
+    std::size_t GetNPlaced() const
+    {
+        return m_rx.size() - m_unplaced.size();
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_updateEvent.Cancel();
+        m_rx.clear();
+        m_cells.clear();
+        m_unplaced.clear();
+        m_mobilityIndex.clear();
+        m_store = nullptr;
+        m_distanceLoss = nullptr;
+        m_distanceLossBatch = nullptr;
+        SpectrumChannel::DoDispose();
+    }
+
+  private:
+    struct RxEntry
+    {
+        Ptr<SpectrumPhy> phy;
+        Ptr<MobilityModel> mobility;
+        uint32_t nodeId;
+        uint32_t slot; //!< position store slot, NONE if not in the store
+        uint64_t cell;
+        bool connected;
+    };
+
+    static uint64_t CellKey(int32_t cx, int32_t cy)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) |
+               static_cast<uint32_t>(cy);
+    }
+
+    int32_t CellCoord(double v) const
+    {
+        return static_cast<int32_t>(std::floor(v / (m_maxRange + m_cellMargin)));
+    }
+
+    uint64_t CellOf(const Vector& p) const
+    {
+        return CellKey(CellCoord(p.x), CellCoord(p.y));
+    }
+
+    void Rebuild()
+    {
+        m_pending = false;
+        // MaxLossDb is the inherited SpectrumChannel attribute
+        DoubleValue maxLoss;
+        GetAttribute("MaxLossDb", maxLoss);
+        m_lossCutoffDb = maxLoss.Get();
+        Ptr<ConstantSpeedPropagationDelayModel> constantSpeed =
+            DynamicCast<ConstantSpeedPropagationDelayModel>(GetPropagationDelayModel());
+        m_speed = constantSpeed ? constantSpeed->GetSpeed() : 0.0;
+        m_cells.clear();
+        m_unplaced.clear();
+        m_mobilityIndex.clear();
+        for (uint32_t i = 0; i < m_rx.size(); ++i)
+        {
+            RxEntry& e = m_rx[i];
+            Ptr<NetDevice> dev = e.phy->GetDevice();
+            if (dev && dev->GetNode())
+            {
+                e.nodeId = dev->GetNode()->GetId();
+            }
+            if (!e.mobility)
+            {
+                e.mobility = e.phy->GetMobility();
+                if (!e.mobility && dev && dev->GetNode())
+                {
+                    e.mobility = dev->GetNode()->GetObject<MobilityModel>();
+                }
+            }
+            if (!e.mobility)
+            {
+                m_unplaced.push_back(i);
+                continue;
+            }
+            if (!e.connected)
+            {
+                e.mobility->TraceConnectWithoutContext(
+                    "CourseChange",
+                    MakeCallback(&GridSpectrumChannel::CourseChanged, this));
+                e.connected = true;
+            }
+            m_mobilityIndex[PeekPointer(e.mobility)] = i;
+            e.slot = m_store ? m_store->SlotOf(e.nodeId) : V2xPositionStore::NONE;
+            e.cell = CellOf(PositionOf(e, Simulator::Now().GetTimeStep()));
+            m_cells[e.cell].push_back(i);
+        }
+        if (!m_updateEvent.IsRunning() && !m_updateInterval.IsZero())
+        {
+            m_updateEvent =
+                Simulator::Schedule(m_updateInterval, &GridSpectrumChannel::PeriodicUpdate, this);
+        }
+    }
+
+    Vector PositionOf(const RxEntry& e, int64_t now) const
+    {
+        return e.slot != V2xPositionStore::NONE ? m_store->Get(e.slot, now)
+                                                : e.mobility->GetPosition();
+    }
+
+    void Move(uint32_t idx)
+    {
+        RxEntry& e = m_rx[idx];
+        uint64_t cell = CellOf(PositionOf(e, Simulator::Now().GetTimeStep()));
+        if (cell == e.cell)
+        {
+            return;
+        }
+        std::vector<uint32_t>& from = m_cells[e.cell];
+        for (std::size_t k = 0; k < from.size(); ++k)
+        {
+            if (from[k] == idx)
+            {
+                from[k] = from.back();
+                from.pop_back();
+                break;
+            }
+        }
+        e.cell = cell;
+        m_cells[cell].push_back(idx);
+    }
+
+    void CourseChanged(Ptr<const MobilityModel> mobility)
+    {
+        if (m_pending)
+        {
+            return;
+        }
+        auto it = m_mobilityIndex.find(PeekPointer(mobility));
+        if (it != m_mobilityIndex.end())
+        {
+            Move(it->second);
+        }
+    }
+
+    void PeriodicUpdate()
+    {
+        if (m_pending)
+        {
+            Rebuild();
+        }
+        for (uint32_t i = 0; i < m_rx.size(); ++i)
+        {
+            if (m_rx[i].mobility)
+            {
+                Move(i);
+            }
+        }
+        m_updateEvent =
+            Simulator::Schedule(m_updateInterval, &GridSpectrumChannel::PeriodicUpdate, this);
+    }
+
+    void Deliver(Ptr<SpectrumSignalParameters> txParams,
+                 Ptr<MobilityModel> txMobility,
+                 const Vector& txPos,
+                 uint32_t txNode,
+                 uint32_t txSlot,
+                 int64_t now,
+                 const RxEntry& rx)
+    {
+        if (rx.phy == txParams->txPhy || rx.nodeId == txNode)
+        {
+            return;
+        }
+        if (!txMobility || !rx.mobility)
+        {
+            Launch(txParams, rx, 0.0, Seconds(0));
+            return;
+        }
+        Vector rxPos = PositionOf(rx, now);
+        double dx = rxPos.x - txPos.x;
+        double dy = rxPos.y - txPos.y;
+        double dz = rxPos.z - txPos.z;
+        const double d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 > m_maxRange * m_maxRange)
+        {
+            return;
+        }
+        // both positions are current: skip the mobility models entirely
+        const bool stored = txSlot != V2xPositionStore::NONE && rx.slot != V2xPositionStore::NONE;
+        if (stored && m_distanceLossBatch)
+        {
+            m_batchRx.push_back(&rx);
+            m_batchD2.push_back(d2);
+            return;
+        }
+        double pathLossDb = 0;
+        Ptr<PropagationLossModel> loss = GetPropagationLossModel();
+        if (stored && m_distanceLoss)
+        {
+            pathLossDb = m_distanceLoss(d2);
+        }
+        else if (loss)
+        {
+            pathLossDb = -loss->CalcRxPower(0, txMobility, rx.mobility);
+        }
+        if (pathLossDb <= m_lossCutoffDb)
+        {
+            Launch(txParams, rx, pathLossDb, DelayOf(txMobility, rx, d2, stored));
+        }
+    }
+
+    /// Path loss for every receiver Deliver() queued, in one batch call.
+    void DeliverBatch(Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility)
+    {
+        const size_t n = m_batchRx.size();
+        if (n == 0)
+        {
+            return;
+        }
+        m_batchLoss.resize(n);
+        m_distanceLossBatch(m_batchD2.data(), m_batchLoss.data(), n);
+        for (size_t k = 0; k < n; ++k)
+        {
+            if (m_batchLoss[k] <= m_lossCutoffDb)
+            {
+                const RxEntry& rx = *m_batchRx[k];
+                Launch(txParams, rx, m_batchLoss[k], DelayOf(txMobility, rx, m_batchD2[k], true));
+            }
+        }
+        m_batchRx.clear();
+        m_batchD2.clear();
+    }
+
+    Time DelayOf(Ptr<MobilityModel> txMobility, const RxEntry& rx, double d2, bool stored) const
+    {
+        if (stored && m_speed > 0)
+        {
+            return Seconds(std::sqrt(d2) / m_speed);
+        }
+        Ptr<PropagationDelayModel> delayModel = GetPropagationDelayModel();
+        return delayModel ? delayModel->GetDelay(txMobility, rx.mobility) : Seconds(0);
+    }
+
+    void Launch(Ptr<SpectrumSignalParameters> txParams,
+                const RxEntry& rx,
+                double pathLossDb,
+                Time delay)
+    {
+        Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+        if (pathLossDb != 0)
+        {
+            *(rxParams->psd) *= std::pow(10.0, -pathLossDb / 10.0);
+        }
+        if (rx.nodeId != std::numeric_limits<uint32_t>::max())
+        {
+            Simulator::ScheduleWithContext(rx.nodeId,
+                                           delay,
+                                           &GridSpectrumChannel::StartRx,
+                                           rxParams,
+                                           rx.phy);
+        }
+        else
+        {
+            Simulator::Schedule(delay, &GridSpectrumChannel::StartRx, rxParams, rx.phy);
+        }
+    }
+
+    static void StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+    {
+        receiver->StartRx(params);
+    }
+
+    double m_maxRange{250.0};
+    double m_cellMargin{50.0};
+    double m_lossCutoffDb{std::numeric_limits<double>::max()};
+    double m_speed{0.0}; //!< ConstantSpeed delay model speed, 0 if another model
+    Time m_updateInterval;
+    EventId m_updateEvent;
+    bool m_pending{false};
+    std::vector<RxEntry> m_rx;
+    std::vector<uint32_t> m_unplaced;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+    std::unordered_map<const MobilityModel*, uint32_t> m_mobilityIndex;
+    Ptr<V2xPositionStore> m_store;
+    std::function<double(double)> m_distanceLoss;
+    std::function<void(const double*, double*, size_t)> m_distanceLossBatch;
+    std::vector<const RxEntry*> m_batchRx; //!< in-range receivers of the current StartTx
+    std::vector<double> m_batchD2;
+    std::vector<double> m_batchLoss;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(GridSpectrumChannel);
+
+/// Distance at which LogDistance loss drops a transmission below the RX
+/// sensitivity; the natural MaxRange for GridSpectrumChannel.
+inline double
+LogDistanceRange(double txPowerDbm,
+                 double rxSensitivityDbm,
+                 double exponent = 3.0,
+                 double referenceLossDb = 46.6777,
+                 double referenceDistance = 1.0)
+{
+    return referenceDistance *
+           std::pow(10.0, (txPowerDbm - referenceLossDb - rxSensitivityDbm) / (10.0 * exponent));
+}
+
+/// LogDistancePropagationLossModel's path loss (dB) at squared distance d2.
+inline double
+LogDistanceLossDb(double d2,
+                  double exponent = 3.0,
+                  double referenceLossDb = 46.6777,
+                  double referenceDistance = 1.0)
+{
+    if (d2 <= referenceDistance * referenceDistance)
+    {
+        return referenceLossDb;
+    }
+    // 10 n log10(d / d0) = 5 n log10(d^2 / d0^2)
+    return referenceLossDb +
+           5.0 * exponent * std::log10(d2 / (referenceDistance * referenceDistance));
+}
+
+} // namespace ns3
+
+#endif /* V2X_GRID_SPECTRUM_CHANNEL_H */
@@ -0,0 +1,257 @@
+/* v2x-loss-table.h
+ *
+ * Tabulated LogDistance path loss (--lossModel=table).
+ * - Indexed by the bit pattern of the squared distance: the IEEE-754
+ *   exponent and the top `mantissaBits` mantissa bits of d^2 select a
+ *   bin, the remaining mantissa bits interpolate linearly inside it. No
+ *   sqrt or log10 per (sender, receiver) pair; the default table is about
+ *   a thousand doubles
+ * - Bins are log-spaced, so the relative resolution is the same at 2 m and
+ *   at 2 km; beyond MaxDistance the analytic formula is used
+ * - A batch entry point evaluates a whole receiver array in one
+ *   branch-light loop the compiler can vectorise
+ *
+ * Accuracy: inside a bin d^2 = 2^e (1 + m) with m spanning h = 2^-bits, and
+ * the loss is c log2(1 + m) + const with c = 5 n log10(2). Linear
+ * interpolation of log2(1 + m) over h is off by at most h^2 / (8 ln 2), so
+ *
+ *     |table - analytic| <= 5 n log10(2) 2^(-2 bits) / (8 ln 2)  dB
+ *
+ * e.g. 7.9e-4 dB for n = 3 and the default 5 bits, 5.0e-5 dB for 7 bits.
+ * MaxErrorDb() returns this bound. Below the reference distance the loss
+ * is the reference loss, exactly as in LogDistancePropagationLossModel.
+ */
+
+#ifndef V2X_LOSS_TABLE_H
+#define V2X_LOSS_TABLE_H
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/uinteger.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xLossTable
+{
+  public:
+    void Build(double exponent,
+               double referenceLossDb,
+               double referenceDistance,
+               double maxDistance,
+               uint32_t mantissaBits)
+    {
+        NS_ABORT_MSG_IF(mantissaBits < 1 || mantissaBits > 16,
+                        "Loss table mantissa bits must be in [1, 16]");
+        NS_ABORT_MSG_IF(maxDistance <= referenceDistance,
+                        "Loss table max distance must exceed the reference distance");
+        m_exponent = exponent;
+        m_referenceLossDb = referenceLossDb;
+        m_d0sq = referenceDistance * referenceDistance;
+        m_bits = mantissaBits;
+        m_shift = 52 - mantissaBits;
+        m_fracMask = (uint64_t(1) << m_shift) - 1;
+        m_fracScale = 1.0 / double(uint64_t(1) << m_shift);
+        m_baseKey = Bits(m_d0sq) >> m_shift;
+        // one entry past the bin holding maxDistance^2 so i + 1 is valid
+        const uint64_t lastKey = (Bits(maxDistance * maxDistance) >> m_shift) + 1;
+        m_table.resize(lastKey - m_baseKey + 1);
+        // unclamped, so the first bin (which starts below d0^2) interpolates
+        // the same log curve as the others
+        for (uint64_t k = 0; k < m_table.size(); ++k)
+        {
+            const double x = FromBits((m_baseKey + k) << m_shift);
+            m_table[k] = m_referenceLossDb + 5.0 * m_exponent * std::log10(x / m_d0sq);
+        }
+    }
+
+    /// Path loss (dB) at squared distance d2 (m^2).
+    double LossDb(double d2) const
+    {
+        if (d2 <= m_d0sq)
+        {
+            return m_referenceLossDb;
+        }
+        const uint64_t bits = Bits(d2);
+        const uint64_t i = (bits >> m_shift) - m_baseKey;
+        if (i + 1 >= m_table.size())
+        {
+            return Analytic(d2);
+        }
+        const double frac = double(bits & m_fracMask) * m_fracScale;
+        return m_table[i] + frac * (m_table[i + 1] - m_table[i]);
+    }
+
+    /// lossDb[k] = LossDb(d2[k]) for k < n.
+    void LossDbBatch(const double* d2, double* lossDb, size_t n) const
+    {
+        const double* table = m_table.data();
+        const uint64_t last = m_table.size() - 1;
+        bool outside = false;
+        for (size_t k = 0; k < n; ++k)
+        {
+            // clamp instead of branching; out-of-table values are redone below
+            const double x = d2[k] > m_d0sq ? d2[k] : m_d0sq;
+            const uint64_t bits = Bits(x);
+            const uint64_t i = (bits >> m_shift) - m_baseKey;
+            outside |= i >= last;
+            const uint64_t j = i < last ? i : last - 1;
+            const double frac = double(bits & m_fracMask) * m_fracScale;
+            const double loss = table[j] + frac * (table[j + 1] - table[j]);
+            lossDb[k] = d2[k] > m_d0sq ? loss : m_referenceLossDb;
+        }
+        if (!outside)
+        {
+            return;
+        }
+        for (size_t k = 0; k < n; ++k)
+        {
+            if (d2[k] > m_d0sq && (Bits(d2[k]) >> m_shift) - m_baseKey >= last)
+            {
+                lossDb[k] = Analytic(d2[k]);
+            }
+        }
+    }
+
+    /// Interpolation error bound (dB) against the analytic model.
+    double MaxErrorDb() const
+    {
+        const double h = std::ldexp(1.0, -int(m_bits));
+        return 5.0 * m_exponent * std::log10(2.0) * h * h / (8.0 * std::log(2.0));
+    }
+
+    size_t GetSize() const
+    {
+        return m_table.size();
+    }
+
+    double Analytic(double d2) const
+    {
+        if (d2 <= m_d0sq)
+        {
+            return m_referenceLossDb;
+        }
+        // 10 n log10(d / d0) = 5 n log10(d^2 / d0^2)
+        return m_referenceLossDb + 5.0 * m_exponent * std::log10(d2 / m_d0sq);
+    }
+
+  private:
+    static uint64_t Bits(double x)
+    {
+        uint64_t b;
+        std::memcpy(&b, &x, sizeof(b));
+        return b;
+    }
+
+    static double FromBits(uint64_t b)
+    {
+        double x;
+        std::memcpy(&x, &b, sizeof(x));
+        return x;
+    }
+
+    double m_exponent{3.0};
+    double m_referenceLossDb{46.6777};
+    double m_d0sq{1.0};
+    uint32_t m_bits{5};
+    uint32_t m_shift{47};
+    uint64_t m_fracMask{0};
+    double m_fracScale{0};
+    uint64_t m_baseKey{0};
+    std::vector<double> m_table;
+};
+
+/**
+ * Drop-in replacement for LogDistancePropagationLossModel (same attributes
+ * and defaults) backed by a V2xLossTable. The table is built when the
+ * object is constructed, so set the attributes through the helper /
+ * CreateObjectWithAttributes rather than afterwards.
+ */
+class V2xTabulatedLossModel : public PropagationLossModel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::V2xTabulatedLossModel")
+                .SetParent<PropagationLossModel>()
+                .SetGroupName("Propagation")
+                .AddConstructor<V2xTabulatedLossModel>()
+                .AddAttribute("Exponent",
+                              "The exponent of the Path Loss propagation model",
+                              DoubleValue(3.0),
+                              MakeDoubleAccessor(&V2xTabulatedLossModel::m_exponent),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("ReferenceDistance",
+                              "The distance at which the reference loss is calculated (m)",
+                              DoubleValue(1.0),
+                              MakeDoubleAccessor(&V2xTabulatedLossModel::m_referenceDistance),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("ReferenceLoss",
+                              "The reference loss at reference distance (dB)",
+                              DoubleValue(46.6777),
+                              MakeDoubleAccessor(&V2xTabulatedLossModel::m_referenceLoss),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("MaxDistance",
+                              "Distance covered by the table; beyond it the formula is used (m)",
+                              DoubleValue(100000.0),
+                              MakeDoubleAccessor(&V2xTabulatedLossModel::m_maxDistance),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("MantissaBits",
+                              "Mantissa bits of d^2 per bin (table resolution)",
+                              UintegerValue(5),
+                              MakeUintegerAccessor(&V2xTabulatedLossModel::m_mantissaBits),
+                              MakeUintegerChecker<uint32_t>(1, 16));
+        return tid;
+    }
+
+    const V2xLossTable& GetTable() const
+    {
+        return m_table;
+    }
+
+  protected:
+    void NotifyConstructionCompleted() override
+    {
+        PropagationLossModel::NotifyConstructionCompleted();
+        m_table.Build(m_exponent, m_referenceLoss, m_referenceDistance, m_maxDistance, m_mantissaBits);
+    }
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override
+    {
+        const Vector pa = a->GetPosition();
+        const Vector pb = b->GetPosition();
+        const double dx = pa.x - pb.x;
+        const double dy = pa.y - pb.y;
+        const double dz = pa.z - pb.z;
+        return txPowerDbm - m_table.LossDb(dx * dx + dy * dy + dz * dz);
+    }
+
+    int64_t DoAssignStreams(int64_t) override
+    {
+        return 0;
+    }
+
+    double m_exponent{3.0};
+    double m_referenceDistance{1.0};
+    double m_referenceLoss{46.6777};
+    double m_maxDistance{100000.0};
+    uint32_t m_mantissaBits{5};
+    V2xLossTable m_table;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(V2xTabulatedLossModel);
+
+} // namespace ns3
+
+#endif /* V2X_LOSS_TABLE_H */
@@ -0,0 +1,303 @@
+/* v2x-metrics.h
+ *
+ * Vehicle -> RSU delivery metrics, a lightweight alternative to FlowMonitor.
+ * - Per-vehicle counters in dense arrays indexed by the stamped vehicle
+ *   index, no 5-tuple classification or per-flow maps
+ * - Latency percentiles from a streaming log-bucket quantile sketch with
+ *   bounded relative error
+ * - Time-average and peak age of information per vehicle -> RSU pair
+ *
+ * Senders stamp payloads with V2xStampHeader; the RSU receive path calls
+ * OnReceive() with the packet as it comes off the socket.
+ */
+
+#ifndef V2X_METRICS_H
+#define V2X_METRICS_H
+
+#include "ns3/abort.h"
+#include "ns3/packet.h"
+
+#include "v2x-stamp-header.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Streaming quantile sketch: values are counted in logarithmic buckets of
+ * ratio gamma = (1 + a) / (1 - a), so any reported quantile is within a
+ * relative error `a` of a true sample. Buckets are a dense array over
+ * [minValue, maxValue]; values outside are clamped to the edge buckets.
+ * Two sketches with the same parameters merge by adding bucket counts.
+ */
+class V2xQuantileSketch
+{
+  public:
+    explicit V2xQuantileSketch(double relativeError = 0.01,
+                               double minValue = 1e3,  // 1 us in ns
+                               double maxValue = 1e11) // 100 s in ns
+        : m_minValue(minValue)
+    {
+        NS_ABORT_MSG_IF(relativeError <= 0 || relativeError >= 1,
+                        "Quantile sketch relative error must be in (0, 1)");
+        m_gamma = (1 + relativeError) / (1 - relativeError);
+        m_logGamma = std::log(m_gamma);
+        m_buckets.assign(Index(maxValue) + 1, 0);
+    }
+
+    void Add(double value)
+    {
+        size_t i = std::min(Index(value), m_buckets.size() - 1);
+        ++m_buckets[i];
+        ++m_count;
+    }
+
+    /// Value at quantile q in [0, 1]; 0 if the sketch is empty.
+    double Quantile(double q) const
+    {
+        if (m_count == 0)
+        {
+            return 0.0;
+        }
+        uint64_t rank = static_cast<uint64_t>(q * (m_count - 1));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < m_buckets.size(); ++i)
+        {
+            seen += m_buckets[i];
+            if (seen > rank)
+            {
+                // bucket i holds (lower, lower * gamma]; report its midpoint
+                // in relative terms so the error stays within `a`
+                double lower = m_minValue * std::pow(m_gamma, double(i) - 1.0);
+                return i == 0 ? m_minValue : 2.0 * lower * m_gamma / (1 + m_gamma);
+            }
+        }
+        return m_minValue * std::pow(m_gamma, double(m_buckets.size() - 1));
+    }
+
+    uint64_t GetCount() const
+    {
+        return m_count;
+    }
+
+    /// Bucket counts, for merging sketches across processes.
+    std::vector<uint64_t>& GetBuckets()
+    {
+        return m_buckets;
+    }
+
+    /// Recompute the total after the buckets were changed directly.
+    void Recount()
+    {
+        m_count = 0;
+        for (uint64_t c : m_buckets)
+        {
+            m_count += c;
+        }
+    }
+
+  private:
+    size_t Index(double value) const
+    {
+        if (value <= m_minValue)
+        {
+            return 0;
+        }
+        return static_cast<size_t>(std::ceil(std::log(value / m_minValue) / m_logGamma));
+    }
+
+    double m_minValue;
+    double m_gamma;
+    double m_logGamma;
+    uint64_t m_count{0};
+    std::vector<uint64_t> m_buckets;
+};
+
+class V2xMetricsCollector
+{
+  public:
+    /// Totals over all vehicles; plain data so ranks can sum it directly.
+    struct Totals
+    {
+        uint64_t sent;
+        uint64_t received;
+        uint64_t stale;
+        double latencySumNs;
+        double aoiAreaNs2;   //!< integral of age over the observed spans
+        double aoiSpanNs;    //!< total length of the observed spans
+        double peakAoiSumNs; //!< sum of age just before each fresh update
+        uint64_t peakAoiCount;
+    };
+
+    void Configure(uint32_t nVehicles)
+    {
+        m_v.assign(nVehicles, {});
+        m_sketch = V2xQuantileSketch();
+        m_unstamped = 0;
+    }
+
+    bool IsEnabled() const
+    {
+        return !m_v.empty();
+    }
+
+    /// Prepend a stamp for vehicle `idx` to `p` and count the send.
+    void Stamp(Ptr<Packet> p, uint32_t idx, int64_t nowNs)
+    {
+        V2xStampHeader hdr;
+        hdr.Set(idx, m_v[idx].sent++, nowNs);
+        p->AddHeader(hdr);
+    }
+
+    /// Count a send stamped elsewhere (e.g. by an application).
+    void OnSent(Ptr<const Packet> p)
+    {
+        V2xStampHeader hdr;
+        if (V2xStampHeader::Peek(p, hdr) && hdr.GetVehicle() < m_v.size())
+        {
+            ++m_v[hdr.GetVehicle()].sent;
+        }
+    }
+
+    /// Returns the packet's latency in ns, or -1 if it carries no stamp.
+    double OnReceive(Ptr<const Packet> p, int64_t nowNs)
+    {
+        V2xStampHeader hdr;
+        if (!V2xStampHeader::Peek(p, hdr) || hdr.GetVehicle() >= m_v.size())
+        {
+            ++m_unstamped;
+            return -1;
+        }
+        Vehicle& v = m_v[hdr.GetVehicle()];
+        const int64_t gen = hdr.GetTxTimeNs();
+        const double latency = double(nowNs - gen);
+        ++v.received;
+        v.latencySumNs += latency;
+        v.latencyMaxNs = std::max(v.latencyMaxNs, latency);
+        m_sketch.Add(latency);
+
+        if (v.lastRxNs >= 0 && gen <= v.lastGenNs)
+        {
+            // overtaken by a fresher packet: delivered, but the age is unchanged
+            ++v.stale;
+            return latency;
+        }
+        if (v.lastRxNs >= 0)
+        {
+            const double dt = double(nowNs - v.lastRxNs);
+            const double age0 = double(v.lastRxNs - v.lastGenNs);
+            v.aoiAreaNs2 += dt * age0 + 0.5 * dt * dt;
+            v.aoiSpanNs += dt;
+            v.peakAoiSumNs += double(nowNs - v.lastGenNs);
+            ++v.peakAoiCount;
+        }
+        v.lastRxNs = nowNs;
+        v.lastGenNs = gen;
+        return latency;
+    }
+
+    /// Extend every vehicle's age curve to `endNs` (call once, at the end).
+    void Finish(int64_t endNs)
+    {
+        for (Vehicle& v : m_v)
+        {
+            if (v.lastRxNs >= 0 && endNs > v.lastRxNs)
+            {
+                const double dt = double(endNs - v.lastRxNs);
+                v.aoiAreaNs2 += dt * double(v.lastRxNs - v.lastGenNs) + 0.5 * dt * dt;
+                v.aoiSpanNs += dt;
+                v.lastRxNs = endNs;
+            }
+        }
+    }
+
+    Totals GetTotals() const
+    {
+        Totals t{};
+        for (const Vehicle& v : m_v)
+        {
+            t.sent += v.sent;
+            t.received += v.received;
+            t.stale += v.stale;
+            t.latencySumNs += v.latencySumNs;
+            t.aoiAreaNs2 += v.aoiAreaNs2;
+            t.aoiSpanNs += v.aoiSpanNs;
+            t.peakAoiSumNs += v.peakAoiSumNs;
+            t.peakAoiCount += v.peakAoiCount;
+        }
+        return t;
+    }
+
+    V2xQuantileSketch& GetSketch()
+    {
+        return m_sketch;
+    }
+
+    uint64_t GetUnstamped() const
+    {
+        return m_unstamped;
+    }
+
+    /// One row per vehicle that sent or received anything.
+    void WriteCsv(const std::string& fileName) const
+    {
+        std::ofstream os(fileName);
+        NS_ABORT_MSG_IF(!os.is_open(), "Cannot open metrics file " << fileName);
+        os << "vehicle,sent,received,stale,pdr,mean_latency_ms,max_latency_ms,"
+              "mean_aoi_ms,mean_peak_aoi_ms\n";
+        for (uint32_t i = 0; i < m_v.size(); ++i)
+        {
+            const Vehicle& v = m_v[i];
+            if (v.sent == 0 && v.received == 0)
+            {
+                continue;
+            }
+            os << i << ',' << v.sent << ',' << v.received << ',' << v.stale << ','
+               << (v.sent ? double(v.received) / v.sent : 0.0) << ','
+               << (v.received ? v.latencySumNs / v.received / 1e6 : 0.0) << ','
+               << v.latencyMaxNs / 1e6 << ','
+               << (v.aoiSpanNs > 0 ? v.aoiAreaNs2 / v.aoiSpanNs / 1e6 : 0.0) << ','
+               << (v.peakAoiCount ? v.peakAoiSumNs / v.peakAoiCount / 1e6 : 0.0) << '\n';
+        }
+    }
+
+    struct Vehicle
+    {
+        uint32_t sent{0};
+        uint32_t received{0};
+        uint32_t stale{0}; //!< received after a fresher packet
+        int64_t lastRxNs{-1};
+        int64_t lastGenNs{0};
+        double latencySumNs{0};
+        double latencyMaxNs{0};
+        double aoiAreaNs2{0};
+        double aoiSpanNs{0};
+        double peakAoiSumNs{0};
+        uint64_t peakAoiCount{0};
+    };
+
+    uint32_t GetNVehicles() const
+    {
+        return static_cast<uint32_t>(m_v.size());
+    }
+
+    const Vehicle& GetVehicle(uint32_t idx) const
+    {
+        return m_v[idx];
+    }
+
+  private:
+    std::vector<Vehicle> m_v;
+    V2xQuantileSketch m_sketch;
+    uint64_t m_unstamped{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_METRICS_H */
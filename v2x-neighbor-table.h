@@ -0,0 +1,139 @@
+/* v2x-neighbor-table.h
+ *
+ * Static neighbour resolution shared by every node (--arpMode=shared).
+ * - One contiguous IP -> MAC table built once from the assigned
+ *   Ipv4InterfaceContainer; addresses on the subnet map to a dense index
+ *   (address - first address), so Lookup()/IndexOf() are O(1)
+ * - One ArpCache holding a permanent entry per address is installed on all
+ *   interfaces instead of a CreateObject<ArpCache>() per vehicle
+ *
+ * Every on-link address must be in the table: the shared cache has no
+ * owning device, so a miss would send its ARP request from the wrong node.
+ */
+
+#ifndef V2X_NEIGHBOR_TABLE_H
+#define V2X_NEIGHBOR_TABLE_H
+
+#include "ns3/abort.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xNeighborTable : public SimpleRefCount<V2xNeighborTable>
+{
+  public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    /// Fill the table from every (interface, address) pair in `interfaces`.
+    void Build(const Ipv4InterfaceContainer& interfaces)
+    {
+        m_mac.clear();
+        m_node.clear();
+        if (interfaces.GetN() == 0)
+        {
+            return;
+        }
+        uint32_t lo = UINT32_MAX;
+        uint32_t hi = 0;
+        for (uint32_t i = 0; i < interfaces.GetN(); ++i)
+        {
+            uint32_t a = interfaces.GetAddress(i).Get();
+            lo = std::min(lo, a);
+            hi = std::max(hi, a);
+        }
+        NS_ABORT_MSG_IF(hi - lo >= (1u << 24), "Neighbor table address range too sparse");
+        m_base = lo;
+        m_mac.assign(hi - lo + 1, Mac48Address());
+        m_node.assign(hi - lo + 1, NONE);
+        for (uint32_t i = 0; i < interfaces.GetN(); ++i)
+        {
+            std::pair<Ptr<Ipv4>, uint32_t> p = interfaces.Get(i);
+            Ptr<NetDevice> dev = p.first->GetNetDevice(p.second);
+            uint32_t k = interfaces.GetAddress(i).Get() - m_base;
+            m_mac[k] = Mac48Address::ConvertFrom(dev->GetAddress());
+            m_node[k] = dev->GetNode()->GetId();
+        }
+    }
+
+    /// Dense index of `ip`, NONE if it is not in the table.
+    uint32_t IndexOf(Ipv4Address ip) const
+    {
+        uint32_t k = ip.Get() - m_base;
+        return k < m_node.size() && m_node[k] != NONE ? k : NONE;
+    }
+
+    /// MAC of `ip`; `ip` must be in the table.
+    const Mac48Address& Lookup(Ipv4Address ip) const
+    {
+        uint32_t k = IndexOf(ip);
+        NS_ASSERT_MSG(k != NONE, "No neighbor entry for " << ip);
+        return m_mac[k];
+    }
+
+    /// Node id owning `ip`; `ip` must be in the table.
+    uint32_t GetNode(Ipv4Address ip) const
+    {
+        uint32_t k = IndexOf(ip);
+        NS_ASSERT_MSG(k != NONE, "No neighbor entry for " << ip);
+        return m_node[k];
+    }
+
+    uint32_t GetN() const
+    {
+        return static_cast<uint32_t>(std::count_if(m_node.begin(), m_node.end(), [](uint32_t n) {
+            return n != NONE;
+        }));
+    }
+
+    /// One ArpCache with a permanent entry per address in the table.
+    Ptr<ArpCache> CreateArpCache() const
+    {
+        Ptr<ArpCache> arp = CreateObject<ArpCache>();
+        arp->SetAliveTimeout(Seconds(3600));
+        for (uint32_t k = 0; k < m_node.size(); ++k)
+        {
+            if (m_node[k] == NONE)
+            {
+                continue;
+            }
+            ArpCache::Entry* entry = arp->Add(Ipv4Address(m_base + k));
+            entry->SetMacAddress(m_mac[k]);
+            entry->MarkPermanent();
+        }
+        return arp;
+    }
+
+    /// Install one shared cache on every interface in `interfaces`.
+    Ptr<ArpCache> InstallShared(const Ipv4InterfaceContainer& interfaces) const
+    {
+        Ptr<ArpCache> arp = CreateArpCache();
+        for (uint32_t i = 0; i < interfaces.GetN(); ++i)
+        {
+            std::pair<Ptr<Ipv4>, uint32_t> p = interfaces.Get(i);
+            Ptr<Ipv4L3Protocol> l3 = DynamicCast<Ipv4L3Protocol>(p.first);
+            NS_ABORT_MSG_IF(!l3, "Shared neighbor table needs Ipv4L3Protocol");
+            l3->GetInterface(p.second)->SetArpCache(arp);
+        }
+        return arp;
+    }
+
+  private:
+    uint32_t m_base{0};
+    std::vector<Mac48Address> m_mac;
+    std::vector<uint32_t> m_node; //!< owning node id, NONE for holes
+};
+
+} // namespace ns3
+
+#endif /* V2X_NEIGHBOR_TABLE_H */
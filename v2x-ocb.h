@@ -0,0 +1,57 @@
+/* v2x-ocb.h
+ *
+ * 802.11p / WAVE channel plan for --wifiMode=ocb.
+ * - 10 MHz channels in the 5.9 GHz band: control channel (CCH) 178 and up
+ *   to six service channels (SCH) 172, 174, 176, 180, 182, 184
+ * - Every node has an OCB device on the CCH, which carries the RSU beacons
+ *   and, with no service channels, everything else
+ * - With --nServiceChannels=K, vehicle i also gets a device on SCH
+ *   i mod K and every RSU one device per SCH; vehicle DATA goes to the
+ *   RSU's address on the vehicle's SCH, so each SCH is its own contention
+ *   domain with ~1/K of the vehicles
+ *
+ * Each channel is a separate channel object: there is no adjacent-channel
+ * interference between them, and devices do not switch channels (no
+ * 1609.4 alternating access), as with continuous-access dual-radio units.
+ */
+
+#ifndef V2X_OCB_H
+#define V2X_OCB_H
+
+#include "ns3/abort.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ns3
+{
+
+struct V2xOcbChannels
+{
+    static constexpr uint16_t CCH = 178;
+    static constexpr uint32_t MAX_SCH = 6;
+
+    /// Channel number of service channel `k` < MAX_SCH.
+    static uint16_t Sch(uint32_t k)
+    {
+        static const uint16_t sch[MAX_SCH] = {172, 174, 176, 180, 182, 184};
+        NS_ABORT_MSG_IF(k >= MAX_SCH, "Only " << MAX_SCH << " 802.11p service channels");
+        return sch[k];
+    }
+
+    /// WifiPhy ChannelSettings value for a 10 MHz channel.
+    static std::string Settings(uint16_t channel)
+    {
+        return "{" + std::to_string(channel) + ", 10, BAND_5GHZ, 0}";
+    }
+
+    /// Service channel of vehicle `i` when there are `nSch` (> 0).
+    static uint32_t ServiceChannelOf(uint32_t i, uint32_t nSch)
+    {
+        return i % nSch;
+    }
+};
+
+} // namespace ns3
+
+#endif /* V2X_OCB_H */
@@ -0,0 +1,158 @@
+/* v2x-online-stats.h
+ *
+ * Online per-RSU statistics during the run (--statsInterval).
+ * - V2xRsuCounters: running totals the hot callbacks bump per RSU (vehicle
+ *   packets sent to it - DATA, and in beacon mode also the probes, which
+ *   the RSU counts on receive as well - received, bytes, stamped latency
+ *   sum and count)
+ * - Every interval one event takes the delta of each RSU's counters
+ *   against the previous snapshot, O(1) per RSU whatever the number of
+ *   flows or packets, and appends one line per RSU: windowed PDR, mean
+ *   latency, throughput and the channel busy ratio seen at the RSU
+ * - CBR: Wi-Fi from V2xBusyTimeMeter on the RSU PHY (time not
+ *   IDLE/SLEEP/OFF in the window), sidelink from the device's own
+ *   subchannel CBR
+ * - Lines are flushed at the end of every window, so the file is complete
+ *   up to the last window even if the run dies; it is opened for append,
+ *   and a FIFO works as well for live consumers
+ *
+ * In distributed mode every rank writes its own file and counts only the
+ * DATA its vehicles sent and its RSUs received.
+ *
+ * Output: <outputPrefix>-online.csv
+ *   time_s,rsu,txPackets,rxPackets,pdr,meanLatencyMs,throughputKbps,cbr
+ */
+
+#ifndef V2X_ONLINE_STATS_H
+#define V2X_ONLINE_STATS_H
+
+#include "ns3/abort.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+
+#include "v2x-busy-time.h"
+#include "v2x-sidelink.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/// Running totals of one RSU, bumped from the send and receive callbacks.
+struct V2xRsuCounters
+{
+    uint64_t txPackets;    //!< probes and DATA sent to this RSU by local vehicles
+    uint64_t rxPackets;
+    uint64_t rxBytes;
+    uint64_t latencyCount; //!< stamped packets among rxPackets
+    double latencySumNs;
+};
+
+class V2xOnlineStats : public SimpleRefCount<V2xOnlineStats>
+{
+  public:
+    /// `counters` is read every window and must outlive the run; devices[r] is RSU r's.
+    void Attach(const std::vector<V2xRsuCounters>* counters,
+                const std::vector<Ptr<NetDevice>>& devices)
+    {
+        NS_ABORT_MSG_IF(counters->size() != devices.size(), "One device per RSU expected");
+        m_counters = counters;
+        m_prev.assign(counters->size(), V2xRsuCounters{});
+        m_busy.Resize(devices.size());
+        m_sidelink.assign(devices.size(), nullptr);
+        for (uint32_t r = 0; r < devices.size(); ++r)
+        {
+            if (Ptr<WifiNetDevice> wd = DynamicCast<WifiNetDevice>(devices[r]))
+            {
+                m_busy.Attach(r, wd->GetPhy());
+            }
+            else
+            {
+                m_sidelink[r] = DynamicCast<V2xSidelinkNetDevice>(devices[r]);
+            }
+        }
+    }
+
+    void Start(Time interval, const std::string& fileName)
+    {
+        NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(), "--statsInterval must be positive");
+        m_os.open(fileName, std::ios::out | std::ios::app);
+        NS_ABORT_MSG_IF(!m_os.is_open(), "Cannot open " << fileName);
+        // tellp() right after an append open is 0 on libstdc++ whatever the size
+        m_os.seekp(0, std::ios::end);
+        if (m_os.tellp() <= 0)
+        {
+            m_os << "time_s,rsu,txPackets,rxPackets,pdr,meanLatencyMs,throughputKbps,cbr\n";
+        }
+        m_interval = interval;
+        m_windowStart = Simulator::Now();
+        m_busy.SetWindowStart(m_windowStart);
+        Simulator::Schedule(interval, &V2xOnlineStats::Sample, this);
+    }
+
+    uint64_t GetWindows() const
+    {
+        return m_windows;
+    }
+
+    void Close()
+    {
+        m_os.close();
+    }
+
+  private:
+    void Sample()
+    {
+        const Time now = Simulator::Now();
+        const double window = (now - m_windowStart).GetSeconds();
+        for (uint32_t r = 0; r < m_prev.size(); ++r)
+        {
+            const V2xRsuCounters& cur = (*m_counters)[r];
+            V2xRsuCounters& prev = m_prev[r];
+            const uint64_t tx = cur.txPackets - prev.txPackets;
+            const uint64_t rx = cur.rxPackets - prev.rxPackets;
+            const uint64_t bytes = cur.rxBytes - prev.rxBytes;
+            const uint64_t stamped = cur.latencyCount - prev.latencyCount;
+            const double latencyNs = cur.latencySumNs - prev.latencySumNs;
+            double cbr = 0.0;
+            if (m_sidelink[r])
+            {
+                cbr = m_sidelink[r]->GetChannelBusyRatio();
+            }
+            else if (m_busy.IsAttached(r))
+            {
+                const double busyNs = static_cast<double>(m_busy.Take(r, now));
+                cbr = window > 0 ? std::min(1.0, busyNs / (window * 1e9)) : 0.0;
+            }
+            m_os << now.GetSeconds() << ',' << r << ',' << tx << ',' << rx << ','
+                 << (tx ? double(rx) / tx : 0.0) << ',' << (stamped ? latencyNs / stamped / 1e6 : 0.0)
+                 << ',' << (window > 0 ? bytes * 8.0 / window / 1000.0 : 0.0) << ',' << cbr << '\n';
+            prev = cur;
+        }
+        m_os.flush();
+        ++m_windows;
+        m_windowStart = now;
+        m_busy.SetWindowStart(now);
+        Simulator::Schedule(m_interval, &V2xOnlineStats::Sample, this);
+    }
+
+    const std::vector<V2xRsuCounters>* m_counters{nullptr};
+    std::vector<V2xRsuCounters> m_prev;
+    V2xBusyTimeMeter m_busy;
+    std::vector<Ptr<V2xSidelinkNetDevice>> m_sidelink;
+    std::ofstream m_os;
+    Time m_interval;
+    Time m_windowStart;
+    uint64_t m_windows{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_ONLINE_STATS_H */
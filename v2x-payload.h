@@ -0,0 +1,127 @@
+/* v2x-payload.h
+ *
+ * Shared immutable payloads for the send paths.
+ * - One template Packet per payload size, built on first use and reused
+ *   for the whole simulation; Get() hands out Packet::Copy()s of it, and
+ *   senders that keep a tagged copy of their own resend it through Copy(),
+ *   so GetCopies() counts every payload Packet made
+ * - A copy shares the template's Buffer, tag lists and metadata
+ *   (reference counted, copy-on-write), so a send allocates only the
+ *   Packet object itself: no Buffer data, no payload bytes
+ * - Zero-filled by default, which ns-3 keeps as a virtual zero area with
+ *   no bytes behind it; SetPattern() swaps in templated content (the
+ *   pattern repeated over the payload), built once per size
+ * - Headers added to a copy (V2xStampHeader, UDP, IP, MAC) go through the
+ *   Buffer's copy-on-write, so the template is never modified
+ *
+ * ns-3 frees Packets through their reference count with plain delete, so
+ * the Packet objects themselves cannot be pooled from outside the class;
+ * what is shared is everything behind them.
+ */
+
+#ifndef V2X_PAYLOAD_H
+#define V2X_PAYLOAD_H
+
+#include "ns3/abort.h"
+#include "ns3/packet.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xPayloadFactory
+{
+  public:
+    /// A copy of the `size`-byte template payload.
+    Ptr<Packet> Get(uint32_t size)
+    {
+        ++m_copies;
+        return Template(size)->Copy();
+    }
+
+    /// A copy of a payload obtained from Get() (e.g. one carrying a sender's tags).
+    Ptr<Packet> Copy(Ptr<const Packet> payload)
+    {
+        ++m_copies;
+        return payload->Copy();
+    }
+
+    /// The template itself: read-only, do not add headers or tags to it.
+    Ptr<const Packet> Template(uint32_t size)
+    {
+        if (size >= m_templates.size())
+        {
+            m_templates.resize(size + 1);
+        }
+        Ptr<Packet>& p = m_templates[size];
+        if (!p)
+        {
+            p = Build(size);
+        }
+        return p;
+    }
+
+    /// Fill payloads with `pattern` repeated; empty = zero-filled. Only
+    /// affects templates built afterwards.
+    void SetPattern(const std::string& pattern)
+    {
+        NS_ABORT_MSG_IF(!m_templates.empty(), "Set the payload pattern before the first packet");
+        m_pattern = pattern;
+    }
+
+    /// Drop all templates; call when the simulation is torn down.
+    void Clear()
+    {
+        m_templates.clear();
+    }
+
+    uint32_t GetNTemplates() const
+    {
+        uint32_t n = 0;
+        for (const Ptr<Packet>& p : m_templates)
+        {
+            n += p ? 1 : 0;
+        }
+        return n;
+    }
+
+    /// Packets made by Get() and Copy().
+    uint64_t GetCopies() const
+    {
+        return m_copies;
+    }
+
+  private:
+    Ptr<Packet> Build(uint32_t size) const
+    {
+        if (m_pattern.empty() || size == 0)
+        {
+            return Create<Packet>(size);
+        }
+        std::vector<uint8_t> bytes(size);
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            bytes[i] = static_cast<uint8_t>(m_pattern[i % m_pattern.size()]);
+        }
+        return Create<Packet>(bytes.data(), size);
+    }
+
+    std::vector<Ptr<Packet>> m_templates; //!< indexed by payload size
+    std::string m_pattern;
+    uint64_t m_copies{0};
+};
+
+/// The process-wide payload factory shared by the scenario and its applications.
+inline V2xPayloadFactory&
+V2xPayloads()
+{
+    static V2xPayloadFactory factory;
+    return factory;
+}
+
+} // namespace ns3
+
+#endif /* V2X_PAYLOAD_H */
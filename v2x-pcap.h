@@ -0,0 +1,325 @@
+/* v2x-pcap.h
+ *
+ * Selective packet capture (--pcapNodes, --pcapSnaplen, --pcapSample,
+ * --pcapFormat); the default options keep helper-based EnablePcapAll.
+ * - Only devices on selected nodes are hooked: all, rsus, vehicles or a
+ *   comma list of node ids
+ * - Frames are truncated to the snaplen and sampled 1 in N per interface
+ *   (the first frame of every interface is kept)
+ * - pcap: one classic file per selected device, named as before
+ *   (<prefix>-<node>-<device>.pcap)
+ * - pcapng: every interface in one <prefix>.pcapng, one Interface
+ *   Description Block per device (node and device in if_name, nanosecond
+ *   timestamps) and one Enhanced Packet Block per frame, all through a
+ *   single block buffer flushed when full
+ *
+ * The access layer decides which trace sources feed Frame() and the link
+ * type of each interface: 802.11 for Wi-Fi (monitor sniffers, every
+ * frame the PHY decodes), raw IP for sidelink.
+ */
+
+#ifndef V2X_PCAP_H
+#define V2X_PCAP_H
+
+#include "ns3/abort.h"
+#include "ns3/net-device.h"
+#include "ns3/node-container.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-helper.h"
+
+#include "v2x-scenario.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/// Buffered pcapng writer: one section, interfaces declared up front.
+class V2xPcapngWriter
+{
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+
+    void Open(const std::string& fileName, size_t capacity = DEFAULT_CAPACITY)
+    {
+        m_os.open(fileName, std::ios::out | std::ios::binary);
+        NS_ABORT_MSG_IF(!m_os.is_open(), "Cannot open " << fileName);
+        m_capacity = capacity;
+        m_buf.reserve(capacity);
+        // Section Header Block: byte-order magic, version 1.0, unknown length
+        Begin(0x0A0D0D0A);
+        Put32(0x1A2B3C4D);
+        Put16(1);
+        Put16(0);
+        Put32(0xffffffff);
+        Put32(0xffffffff);
+        End();
+    }
+
+    /// Interface Description Block; returns the interface id.
+    uint32_t AddInterface(uint16_t linkType, uint32_t snaplen, const std::string& name)
+    {
+        Begin(1);
+        Put16(linkType);
+        Put16(0);
+        Put32(snaplen);
+        PutOption(2, name.data(), name.size()); // if_name
+        const uint8_t nanoseconds = 9;
+        PutOption(9, &nanoseconds, 1); // if_tsresol
+        PutOption(0, nullptr, 0);      // opt_endofopt
+        End();
+        return m_nInterfaces++;
+    }
+
+    /// Enhanced Packet Block, the first `caplen` bytes of `p`.
+    void Write(uint32_t interface, uint64_t timeNs, Ptr<const Packet> p, uint32_t caplen)
+    {
+        const uint32_t len = p->GetSize();
+        caplen = std::min(caplen, len);
+        Begin(6);
+        Put32(interface);
+        Put32(static_cast<uint32_t>(timeNs >> 32));
+        Put32(static_cast<uint32_t>(timeNs));
+        Put32(caplen);
+        Put32(len);
+        const size_t at = m_buf.size();
+        m_buf.resize(at + caplen);
+        p->CopyData(m_buf.data() + at, caplen);
+        Pad();
+        End();
+        if (m_buf.size() >= m_capacity)
+        {
+            Flush();
+        }
+    }
+
+    void Flush()
+    {
+        if (m_os.is_open() && !m_buf.empty())
+        {
+            m_os.write(reinterpret_cast<const char*>(m_buf.data()),
+                       static_cast<std::streamsize>(m_buf.size()));
+            m_buf.clear();
+        }
+    }
+
+    void Close()
+    {
+        if (m_os.is_open())
+        {
+            Flush();
+            m_os.close();
+        }
+    }
+
+  private:
+    void Put16(uint16_t v)
+    {
+        PutBytes(&v, 2);
+    }
+
+    void Put32(uint32_t v)
+    {
+        PutBytes(&v, 4);
+    }
+
+    void PutBytes(const void* data, size_t n)
+    {
+        const uint8_t* b = static_cast<const uint8_t*>(data);
+        m_buf.insert(m_buf.end(), b, b + n);
+    }
+
+    void Pad()
+    {
+        m_buf.resize((m_buf.size() + 3) & ~size_t(3), 0);
+    }
+
+    void PutOption(uint16_t code, const void* data, size_t n)
+    {
+        Put16(code);
+        Put16(static_cast<uint16_t>(n));
+        PutBytes(data, n);
+        Pad();
+    }
+
+    /// Block type and a length placeholder; End() fills it in and repeats it.
+    void Begin(uint32_t type)
+    {
+        m_block = m_buf.size();
+        Put32(type);
+        Put32(0);
+    }
+
+    void End()
+    {
+        const uint32_t total = static_cast<uint32_t>(m_buf.size() - m_block + 4);
+        std::memcpy(m_buf.data() + m_block + 4, &total, 4);
+        Put32(total);
+    }
+
+    std::ofstream m_os;
+    std::vector<uint8_t> m_buf; //!< host byte order, as the SHB magic says
+    size_t m_capacity{DEFAULT_CAPACITY};
+    size_t m_block{0};
+    uint32_t m_nInterfaces{0};
+};
+
+class V2xPcapCapture
+{
+  public:
+    /// LINKTYPE_* values shared by pcap and pcapng.
+    static constexpr uint16_t LINK_IEEE802_11 = 105;
+    static constexpr uint16_t LINK_RAW = 101;
+
+    /// True when the options ask for nothing beyond EnablePcapAll.
+    static bool IsDefault(const ScenarioConfig& cfg)
+    {
+        return cfg.pcapNodes == "all" && cfg.pcapSnaplen == 0 && cfg.pcapSample <= 1 &&
+               cfg.pcapFormat == "pcap";
+    }
+
+    void Configure(const ScenarioConfig& cfg,
+                   const std::string& prefix,
+                   const NodeContainer& vehicles,
+                   const NodeContainer& rsus)
+    {
+        NS_ABORT_MSG_IF(cfg.pcapFormat != "pcap" && cfg.pcapFormat != "pcapng",
+                        "Unknown pcapFormat '" << cfg.pcapFormat << "' (pcap|pcapng)");
+        m_prefix = prefix;
+        m_pcapng = cfg.pcapFormat == "pcapng";
+        m_snaplen = cfg.pcapSnaplen ? cfg.pcapSnaplen : 65535;
+        m_sample = std::max(1u, cfg.pcapSample);
+        if (cfg.pcapNodes == "all" || cfg.pcapNodes == "vehicles")
+        {
+            Select(vehicles);
+        }
+        if (cfg.pcapNodes == "all" || cfg.pcapNodes == "rsus")
+        {
+            Select(rsus);
+        }
+        if (cfg.pcapNodes != "all" && cfg.pcapNodes != "vehicles" && cfg.pcapNodes != "rsus")
+        {
+            std::stringstream ss(cfg.pcapNodes);
+            std::string item;
+            while (std::getline(ss, item, ','))
+            {
+                std::stringstream is(item);
+                uint32_t id;
+                is >> id;
+                NS_ABORT_MSG_IF(is.fail(),
+                                "Bad pcapNodes entry '" << item << "' (all|rsus|vehicles|ids)");
+                Select(id);
+            }
+        }
+        if (m_pcapng)
+        {
+            m_writer.Open(m_prefix + ".pcapng");
+        }
+    }
+
+    bool IsSelected(Ptr<NetDevice> dev) const
+    {
+        const uint32_t id = dev->GetNode()->GetId();
+        return id < m_selected.size() && m_selected[id];
+    }
+
+    /// Declare `dev` as an interface; returns the id to bind into Frame().
+    uint32_t AddInterface(Ptr<NetDevice> dev, uint16_t linkType)
+    {
+        const uint32_t id = static_cast<uint32_t>(m_seen.size());
+        m_seen.push_back(0);
+        if (m_pcapng)
+        {
+            std::ostringstream name;
+            name << "node" << dev->GetNode()->GetId() << "-dev" << dev->GetIfIndex();
+            m_writer.AddInterface(linkType, m_snaplen, name.str());
+        }
+        else
+        {
+            PcapHelper pcap;
+            m_files.push_back(pcap.CreateFile(pcap.GetFilenameFromDevice(m_prefix, dev),
+                                              std::ios::out,
+                                              static_cast<PcapHelper::DataLinkType>(linkType),
+                                              m_snaplen));
+        }
+        return id;
+    }
+
+    /// One frame on interface `id`: sampled, truncated, written.
+    static void Frame(V2xPcapCapture* capture, uint32_t id, Ptr<const Packet> p)
+    {
+        if (capture->m_seen[id]++ % capture->m_sample != 0)
+        {
+            return;
+        }
+        ++capture->m_frames;
+        if (capture->m_pcapng)
+        {
+            capture->m_writer.Write(id,
+                                    static_cast<uint64_t>(Simulator::Now().GetNanoSeconds()),
+                                    p,
+                                    capture->m_snaplen);
+        }
+        else
+        {
+            capture->m_files[id]->Write(Simulator::Now(), p);
+        }
+    }
+
+    uint32_t GetNInterfaces() const
+    {
+        return static_cast<uint32_t>(m_seen.size());
+    }
+
+    uint64_t GetFrames() const
+    {
+        return m_frames;
+    }
+
+    void Close()
+    {
+        m_writer.Close();
+        m_files.clear();
+    }
+
+  private:
+    void Select(const NodeContainer& nodes)
+    {
+        for (uint32_t i = 0; i < nodes.GetN(); ++i)
+        {
+            Select(nodes.Get(i)->GetId());
+        }
+    }
+
+    void Select(uint32_t id)
+    {
+        if (id >= m_selected.size())
+        {
+            m_selected.resize(id + 1, false);
+        }
+        m_selected[id] = true;
+    }
+
+    std::string m_prefix;
+    bool m_pcapng{false};
+    uint32_t m_snaplen{65535};
+    uint32_t m_sample{1};
+    std::vector<bool> m_selected; //!< by node id
+    std::vector<uint64_t> m_seen; //!< frames offered per interface
+    std::vector<Ptr<PcapFileWrapper>> m_files;
+    V2xPcapngWriter m_writer;
+    uint64_t m_frames{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_PCAP_H */
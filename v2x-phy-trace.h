@@ -0,0 +1,206 @@
+/* v2x-phy-trace.h
+ *
+ * Compact binary PHY trace, the default replacement for the ASCII trace.
+ * - One 24-byte record per PHY Tx / RxOk / RxError event instead of a
+ *   ~600-byte text line with the full header dump
+ * - Records go through the same block-buffered writer as the event log
+ * - Sinks are connected per device with the node/device id bound in, so
+ *   no trace context string is built or parsed per event
+ *
+ * Binary layout: 8-byte magic "V2XPHY01", uint32 record size, then packed
+ * V2xPhyTraceRecord structs in host byte order. v2x-trace-reader.cc turns
+ * the file back into text.
+ */
+
+#ifndef V2X_PHY_TRACE_H
+#define V2X_PHY_TRACE_H
+
+#include "ns3/callback.h"
+#include "ns3/net-device-container.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy-state-helper.h"
+#include "ns3/wifi-phy.h"
+
+#include "v2x-event-log.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ns3
+{
+
+/// One PHY event, 24 bytes.
+struct V2xPhyTraceRecord
+{
+    int64_t timeNs;    //!< simulation time
+    uint32_t node;     //!< node id
+    uint32_t size;     //!< PSDU size in bytes (MAC header included)
+    uint32_t rateKbps; //!< data rate, 0 if unknown (RxError)
+    uint16_t seq;      //!< 802.11 sequence number, 0 for non-QoS control frames
+    uint8_t type;      //!< V2xPhyTrace::Event
+    uint8_t flags;     //!< bit 0: retry; bits 4-7: device index on the node
+
+    static void WriteCsvHeader(std::ostream& os)
+    {
+        os << "time_ns,event,node,device,size,seq,retry,rate_kbps\n";
+    }
+
+    void WriteCsv(std::ostream& os) const
+    {
+        static const char* const names[] = {"tx", "rxok", "rxerr"};
+        os << timeNs << ',' << (type < 3 ? names[type] : "?") << ',' << node << ','
+           << (flags >> 4) << ',' << size << ',' << seq << ',' << (flags & 1) << ',' << rateKbps
+           << '\n';
+    }
+};
+
+class V2xPhyTrace
+{
+  public:
+    enum Event : uint8_t
+    {
+        EVENT_TX = 0,
+        EVENT_RX_OK,
+        EVENT_RX_ERROR,
+    };
+
+    static constexpr uint8_t FLAG_RETRY = 0x01;
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    void Open(const std::string& fileName, size_t capacity = DEFAULT_CAPACITY)
+    {
+        m_buffer.Open(fileName, true, "V2XPHY01", capacity);
+    }
+
+    /// Connect the PHY state traces of every WifiNetDevice in `devices`.
+    void Connect(const NetDeviceContainer& devices)
+    {
+        for (uint32_t i = 0; i < devices.GetN(); ++i)
+        {
+            Ptr<WifiNetDevice> dev = DynamicCast<WifiNetDevice>(devices.Get(i));
+            if (!dev)
+            {
+                continue;
+            }
+            uint32_t node = dev->GetNode()->GetId();
+            uint8_t devFlags = static_cast<uint8_t>((dev->GetIfIndex() & 0x0f) << 4);
+            uint16_t width = dev->GetPhy()->GetChannelWidth();
+            Ptr<WifiPhyStateHelper> state = dev->GetPhy()->GetState();
+            state->TraceConnectWithoutContext("Tx",
+                                              MakeBoundCallback(&V2xPhyTrace::TxSink,
+                                                                this,
+                                                                node,
+                                                                devFlags,
+                                                                width));
+            state->TraceConnectWithoutContext("RxOk",
+                                              MakeBoundCallback(&V2xPhyTrace::RxOkSink,
+                                                                this,
+                                                                node,
+                                                                devFlags,
+                                                                width));
+            state->TraceConnectWithoutContext("RxError",
+                                              MakeBoundCallback(&V2xPhyTrace::RxErrorSink,
+                                                                this,
+                                                                node,
+                                                                devFlags));
+        }
+    }
+
+    void Close()
+    {
+        m_buffer.Close();
+    }
+
+    uint64_t GetRecords() const
+    {
+        return m_records;
+    }
+
+    /// Record an event from a non-Wifi device (no 802.11 header to parse).
+    void Record(Event type, uint32_t node, uint8_t devFlags, uint32_t size, uint32_t rateKbps)
+    {
+        V2xPhyTraceRecord r;
+        r.timeNs = Simulator::Now().GetNanoSeconds();
+        r.node = node;
+        r.size = size;
+        r.rateKbps = rateKbps;
+        r.seq = 0;
+        r.type = type;
+        r.flags = devFlags;
+        m_buffer.Push(r);
+        ++m_records;
+    }
+
+  private:
+    void Push(Event type, uint32_t node, uint8_t devFlags, Ptr<const Packet> p, uint32_t rateKbps)
+    {
+        V2xPhyTraceRecord r;
+        r.timeNs = Simulator::Now().GetNanoSeconds();
+        r.node = node;
+        r.size = p->GetSize();
+        r.rateKbps = rateKbps;
+        r.seq = 0;
+        r.type = type;
+        r.flags = devFlags;
+        WifiMacHeader hdr;
+        if (p->PeekHeader(hdr) > 0)
+        {
+            r.seq = hdr.GetSequenceNumber();
+            if (hdr.IsRetry())
+            {
+                r.flags |= FLAG_RETRY;
+            }
+        }
+        m_buffer.Push(r);
+        ++m_records;
+    }
+
+    static uint32_t RateKbps(WifiMode mode, uint16_t width)
+    {
+        return static_cast<uint32_t>(mode.GetDataRate(width) / 1000);
+    }
+
+    static void TxSink(V2xPhyTrace* trace,
+                       uint32_t node,
+                       uint8_t devFlags,
+                       uint16_t width,
+                       Ptr<const Packet> p,
+                       WifiMode mode,
+                       WifiPreamble,
+                       uint8_t)
+    {
+        trace->Push(EVENT_TX, node, devFlags, p, RateKbps(mode, width));
+    }
+
+    static void RxOkSink(V2xPhyTrace* trace,
+                         uint32_t node,
+                         uint8_t devFlags,
+                         uint16_t width,
+                         Ptr<const Packet> p,
+                         double,
+                         WifiMode mode,
+                         WifiPreamble)
+    {
+        trace->Push(EVENT_RX_OK, node, devFlags, p, RateKbps(mode, width));
+    }
+
+    static void RxErrorSink(V2xPhyTrace* trace,
+                            uint32_t node,
+                            uint8_t devFlags,
+                            Ptr<const Packet> p,
+                            double)
+    {
+        trace->Push(EVENT_RX_ERROR, node, devFlags, p, 0);
+    }
+
+    V2xRecordBuffer<V2xPhyTraceRecord> m_buffer;
+    uint64_t m_records{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_PHY_TRACE_H */
@@ -0,0 +1,141 @@
+/* v2x-position-store.h
+ *
+ * Lazily evaluated structure-of-arrays node positions (--positionCache).
+ * - x/y/z live in three dense arrays indexed by a slot per node; node id ->
+ *   slot is a dense vector, so lookups never touch the node or its
+ *   aggregated objects
+ * - A slot is re-evaluated from its MobilityModel at most once per
+ *   simulation timestamp: a broadcast seen by N receivers costs one
+ *   GetPosition() per node, not one per (sender, receiver) pair
+ * - Nodes on a ConstantPositionMobilityModel are evaluated once and only
+ *   again after a CourseChange (SetPosition); moving nodes are stamped with
+ *   the time of their last evaluation
+ *
+ * Read by GridSpectrumChannel and V2xAssociationManager. The Yans channel
+ * queries mobility models itself and does not use the store.
+ */
+
+#ifndef V2X_POSITION_STORE_H
+#define V2X_POSITION_STORE_H
+
+#include "ns3/abort.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/vector.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xPositionStore : public SimpleRefCount<V2xPositionStore>
+{
+  public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    /// Give every node in `nodes` a slot; each must have a MobilityModel.
+    void Add(const NodeContainer& nodes)
+    {
+        for (uint32_t i = 0; i < nodes.GetN(); ++i)
+        {
+            Ptr<Node> node = nodes.Get(i);
+            Ptr<MobilityModel> m = node->GetObject<MobilityModel>();
+            NS_ABORT_MSG_IF(!m, "Position store needs a mobility model on node " << node->GetId());
+            const uint32_t slot = static_cast<uint32_t>(m_model.size());
+            if (node->GetId() >= m_slotOfNode.size())
+            {
+                m_slotOfNode.resize(node->GetId() + 1, NONE);
+            }
+            m_slotOfNode[node->GetId()] = slot;
+            m_model.push_back(m);
+            m_x.push_back(0);
+            m_y.push_back(0);
+            m_z.push_back(0);
+            m_stamp.push_back(STALE);
+            m_static.push_back(DynamicCast<ConstantPositionMobilityModel>(m) != nullptr);
+            m->TraceConnectWithoutContext(
+                "CourseChange",
+                MakeBoundCallback(&V2xPositionStore::CourseChanged, this, slot));
+        }
+    }
+
+    /// Slot of node `nodeId`, NONE if it was not added.
+    uint32_t SlotOf(uint32_t nodeId) const
+    {
+        return nodeId < m_slotOfNode.size() ? m_slotOfNode[nodeId] : NONE;
+    }
+
+    /// Position of `slot` at time step `now` (Simulator::Now().GetTimeStep()).
+    Vector Get(uint32_t slot, int64_t now)
+    {
+        if (m_stamp[slot] != now && m_stamp[slot] != FOREVER)
+        {
+            Refresh(slot, now);
+        }
+        else
+        {
+            ++m_hits;
+        }
+        return Vector(m_x[slot], m_y[slot], m_z[slot]);
+    }
+
+    Vector Get(uint32_t slot)
+    {
+        return Get(slot, Simulator::Now().GetTimeStep());
+    }
+
+    uint32_t GetN() const
+    {
+        return static_cast<uint32_t>(m_model.size());
+    }
+
+    /// GetPosition() calls made on the mobility models so far.
+    uint64_t GetEvaluations() const
+    {
+        return m_evaluations;
+    }
+
+    /// Get() calls answered from the arrays.
+    uint64_t GetHits() const
+    {
+        return m_hits;
+    }
+
+  private:
+    static constexpr int64_t STALE = std::numeric_limits<int64_t>::min();
+    static constexpr int64_t FOREVER = std::numeric_limits<int64_t>::max();
+
+    void Refresh(uint32_t slot, int64_t now)
+    {
+        const Vector p = m_model[slot]->GetPosition();
+        m_x[slot] = p.x;
+        m_y[slot] = p.y;
+        m_z[slot] = p.z;
+        m_stamp[slot] = m_static[slot] ? FOREVER : now;
+        ++m_evaluations;
+    }
+
+    static void CourseChanged(V2xPositionStore* store, uint32_t slot, Ptr<const MobilityModel>)
+    {
+        store->m_stamp[slot] = STALE;
+    }
+
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<int64_t> m_stamp; //!< time of the last evaluation, FOREVER if static
+    std::vector<uint8_t> m_static;
+    std::vector<Ptr<MobilityModel>> m_model;
+    std::vector<uint32_t> m_slotOfNode;
+    uint64_t m_evaluations{0};
+    uint64_t m_hits{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_POSITION_STORE_H */
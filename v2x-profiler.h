@@ -0,0 +1,230 @@
+/* v2x-profiler.h
+ *
+ * Built-in wall-clock profiling (--profile).
+ * - Phase timers: Mark(name) closes the running phase and opens the next,
+ *   so RunScenario() only names its phase boundaries
+ * - V2xCountingScheduler: the default map scheduler plus a pending-event
+ *   counter, installed with Simulator::SetScheduler() in profile mode only
+ * - Sampling every --profileInterval of simulated time: wall time, events
+ *   executed and scheduler queue depth, hence events/s and the simulated
+ *   to real time ratio over the run
+ * - Peak RSS from getrusage()
+ *
+ * Output: <outputPrefix>-profile.json, one object with "phases",
+ * "samples" and the run totals, stable keys for nightly comparisons.
+ */
+
+#ifndef V2X_PROFILER_H
+#define V2X_PROFILER_H
+
+#include "ns3/abort.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/// MapScheduler that keeps count of its pending events.
+class V2xCountingScheduler : public MapScheduler
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::V2xCountingScheduler")
+                                .SetParent<MapScheduler>()
+                                .SetGroupName("Core")
+                                .AddConstructor<V2xCountingScheduler>();
+        return tid;
+    }
+
+    void Insert(const Event& ev) override
+    {
+        MapScheduler::Insert(ev);
+        if (++s_depth > s_peak)
+        {
+            s_peak = s_depth;
+        }
+    }
+
+    Event RemoveNext() override
+    {
+        --s_depth;
+        return MapScheduler::RemoveNext();
+    }
+
+    void Remove(const Event& ev) override
+    {
+        --s_depth;
+        MapScheduler::Remove(ev);
+    }
+
+    /// Pending events in the active scheduler.
+    static uint64_t GetDepth()
+    {
+        return s_depth;
+    }
+
+    static uint64_t GetPeakDepth()
+    {
+        return s_peak;
+    }
+
+    static void Reset()
+    {
+        s_depth = 0;
+        s_peak = 0;
+    }
+
+  private:
+    static inline uint64_t s_depth{0};
+    static inline uint64_t s_peak{0};
+};
+
+NS_OBJECT_ENSURE_REGISTERED(V2xCountingScheduler);
+
+class V2xProfiler : public SimpleRefCount<V2xProfiler>
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    /// Swap in the counting scheduler; call before anything is scheduled.
+    static void InstallScheduler()
+    {
+        V2xCountingScheduler::Reset();
+        ObjectFactory factory;
+        factory.SetTypeId("ns3::V2xCountingScheduler");
+        Simulator::SetScheduler(factory);
+    }
+
+    /// Peak resident set size of this process (KiB).
+    static uint64_t PeakRssKb()
+    {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        return static_cast<uint64_t>(ru.ru_maxrss); // KiB on Linux
+    }
+
+    V2xProfiler()
+        : m_start(Clock::now()),
+          m_phaseStart(m_start)
+    {
+    }
+
+    /// Close the running phase (if any) and start `name`.
+    void Mark(const std::string& name)
+    {
+        const Clock::time_point now = Clock::now();
+        if (!m_phase.empty())
+        {
+            m_phases.push_back({m_phase, Seconds(now - m_phaseStart)});
+        }
+        m_phase = name;
+        m_phaseStart = now;
+    }
+
+    /// Sample every `interval` of simulated time from now on.
+    void StartSampling(Time interval)
+    {
+        NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(), "--profileInterval must be positive");
+        m_interval = interval;
+        m_runStart = Clock::now();
+        m_runStartEvents = Simulator::GetEventCount();
+        Simulator::Schedule(interval, &V2xProfiler::Sample, this);
+    }
+
+    /// After Simulator::Run(): fix the run totals.
+    void StopSampling()
+    {
+        m_runWall = Seconds(Clock::now() - m_runStart);
+        m_runEvents = Simulator::GetEventCount() - m_runStartEvents;
+        m_runSim = Simulator::Now().GetSeconds();
+    }
+
+    double GetEventsPerSecond() const
+    {
+        return m_runWall > 0 ? m_runEvents / m_runWall : 0.0;
+    }
+
+    void Write(const std::string& fileName)
+    {
+        Mark("");
+        std::ofstream os(fileName);
+        NS_ABORT_MSG_IF(!os.is_open(), "Cannot open " << fileName);
+        os << "{\n  \"wallSeconds\": " << Seconds(Clock::now() - m_start)
+           << ",\n  \"runWallSeconds\": " << m_runWall << ",\n  \"simSeconds\": " << m_runSim
+           << ",\n  \"events\": " << m_runEvents << ",\n  \"eventsPerSecond\": "
+           << GetEventsPerSecond() << ",\n  \"simToRealRatio\": "
+           << (m_runWall > 0 ? m_runSim / m_runWall : 0.0)
+           << ",\n  \"peakQueueDepth\": " << V2xCountingScheduler::GetPeakDepth()
+           << ",\n  \"peakRssKb\": " << PeakRssKb() << ",\n  \"phases\": {";
+        for (size_t i = 0; i < m_phases.size(); ++i)
+        {
+            os << (i ? ",\n" : "\n") << "    \"" << m_phases[i].name
+               << "\": " << m_phases[i].seconds;
+        }
+        os << "\n  },\n  \"samples\": [";
+        for (size_t i = 0; i < m_samples.size(); ++i)
+        {
+            const ProfileSample& s = m_samples[i];
+            os << (i ? ",\n" : "\n") << "    {\"sim\": " << s.sim << ", \"wall\": " << s.wall
+               << ", \"events\": " << s.events << ", \"queueDepth\": " << s.depth << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+  private:
+    struct Phase
+    {
+        std::string name;
+        double seconds;
+    };
+
+    struct ProfileSample
+    {
+        double sim;
+        double wall;
+        uint64_t events;
+        uint64_t depth;
+    };
+
+    static double Seconds(Clock::duration d)
+    {
+        return std::chrono::duration<double>(d).count();
+    }
+
+    void Sample()
+    {
+        m_samples.push_back({Simulator::Now().GetSeconds(),
+                             Seconds(Clock::now() - m_runStart),
+                             Simulator::GetEventCount() - m_runStartEvents,
+                             V2xCountingScheduler::GetDepth()});
+        Simulator::Schedule(m_interval, &V2xProfiler::Sample, this);
+    }
+
+    Clock::time_point m_start;
+    Clock::time_point m_phaseStart;
+    Clock::time_point m_runStart;
+    std::string m_phase;
+    std::vector<Phase> m_phases;
+    std::vector<ProfileSample> m_samples;
+    Time m_interval;
+    uint64_t m_runStartEvents{0};
+    uint64_t m_runEvents{0};
+    double m_runWall{0};
+    double m_runSim{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_PROFILER_H */
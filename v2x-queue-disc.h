@@ -0,0 +1,192 @@
+/* v2x-queue-disc.h
+ *
+ * V2X priority queue disc (--queueDisc=v2xPriority).
+ * - Three classes, served in strict priority: safety beacons, event
+ *   messages (DENM) and bulk data
+ * - Classified like PfifoFastQueueDisc, from the packet's
+ *   SocketPriorityTag, through the EDCA access category of that priority:
+ *   AC_VO -> beacon, AC_VI -> DENM, AC_BE / AC_BK (and untagged) -> bulk
+ * - Per-class packet limits; a full beacon class drops its oldest beacon
+ *   to admit the new one, since a newer beacon supersedes it, while the
+ *   other classes drop the arriving packet
+ *
+ * The applications tag their packets (see the Priority attributes in
+ * v2x-beacon-apps.h), so the same classes also select the EDCA queue on a
+ * QoS Wi-Fi MAC.
+ */
+
+#ifndef V2X_QUEUE_DISC_H
+#define V2X_QUEUE_DISC_H
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/qos-utils.h"
+#include "ns3/queue-disc.h"
+#include "ns3/queue-size.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+
+#include <cstdint>
+
+namespace ns3
+{
+
+class V2xPriorityQueueDisc : public QueueDisc
+{
+  public:
+    enum TrafficClass : uint32_t
+    {
+        CLASS_BEACON = 0,
+        CLASS_DENM,
+        CLASS_BULK,
+        N_CLASSES
+    };
+
+    /// Socket priorities the applications use for each class.
+    static constexpr uint8_t PRIORITY_BEACON = 6; // AC_VO
+    static constexpr uint8_t PRIORITY_DENM = 5;   // AC_VI
+    static constexpr uint8_t PRIORITY_BULK = 0;   // AC_BE
+
+    static constexpr const char* STALE_BEACON_DROP = "Stale beacon replaced";
+    static constexpr const char* LIMIT_EXCEEDED_DROP = "Class queue limit exceeded";
+
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::V2xPriorityQueueDisc")
+                .SetParent<QueueDisc>()
+                .SetGroupName("TrafficControl")
+                .AddConstructor<V2xPriorityQueueDisc>()
+                .AddAttribute("BeaconLimit",
+                              "Packets queued in the beacon class",
+                              UintegerValue(2),
+                              MakeUintegerAccessor(&V2xPriorityQueueDisc::m_beaconLimit),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("DenmLimit",
+                              "Packets queued in the DENM class",
+                              UintegerValue(16),
+                              MakeUintegerAccessor(&V2xPriorityQueueDisc::m_denmLimit),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("BulkLimit",
+                              "Packets queued in the bulk class",
+                              UintegerValue(100),
+                              MakeUintegerAccessor(&V2xPriorityQueueDisc::m_bulkLimit),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("BeaconDropOldest",
+                              "A full beacon class drops its oldest beacon instead of the new one",
+                              BooleanValue(true),
+                              MakeBooleanAccessor(&V2xPriorityQueueDisc::m_dropOldest),
+                              MakeBooleanChecker());
+        return tid;
+    }
+
+    V2xPriorityQueueDisc()
+        : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS)
+    {
+    }
+
+    /// Class of socket priority `priority` (0..7).
+    static TrafficClass ClassOf(uint8_t priority)
+    {
+        switch (QosUtilsMapTidToAc(priority & 0x07))
+        {
+        case AC_VO:
+            return CLASS_BEACON;
+        case AC_VI:
+            return CLASS_DENM;
+        default:
+            return CLASS_BULK;
+        }
+    }
+
+    /// Packets admitted by replacing a stale beacon.
+    uint64_t GetStaleBeaconDrops() const
+    {
+        return m_staleDrops;
+    }
+
+  private:
+    bool DoEnqueue(Ptr<QueueDiscItem> item) override
+    {
+        uint8_t priority = 0;
+        SocketPriorityTag priorityTag;
+        if (item->GetPacket()->PeekPacketTag(priorityTag))
+        {
+            priority = priorityTag.GetPriority();
+        }
+        const TrafficClass c = ClassOf(priority);
+        Ptr<InternalQueue> queue = GetInternalQueue(c);
+        if (queue->GetNPackets() >= Limit(c))
+        {
+            if (c != CLASS_BEACON || !m_dropOldest)
+            {
+                DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+                return false;
+            }
+            DropAfterDequeue(queue->Dequeue(), STALE_BEACON_DROP);
+            ++m_staleDrops;
+        }
+        return queue->Enqueue(item);
+    }
+
+    Ptr<QueueDiscItem> DoDequeue() override
+    {
+        for (uint32_t c = 0; c < N_CLASSES; ++c)
+        {
+            Ptr<QueueDiscItem> item = GetInternalQueue(c)->Dequeue();
+            if (item)
+            {
+                return item;
+            }
+        }
+        return nullptr;
+    }
+
+    bool CheckConfig() override
+    {
+        if (GetNQueueDiscClasses() > 0 || GetNPacketFilters() > 0)
+        {
+            NS_FATAL_ERROR("V2xPriorityQueueDisc takes no classes or packet filters");
+            return false;
+        }
+        if (GetNInternalQueues() == 0)
+        {
+            // the class limits are enforced in DoEnqueue; the internal queues
+            // only need to be at least as large
+            for (uint32_t c = 0; c < N_CLASSES; ++c)
+            {
+                AddInternalQueue(CreateObjectWithAttributes<DropTailQueue<QueueDiscItem>>(
+                    "MaxSize",
+                    QueueSizeValue(QueueSize(QueueSizeUnit::PACKETS, Limit(c)))));
+            }
+        }
+        if (GetNInternalQueues() != N_CLASSES)
+        {
+            NS_FATAL_ERROR("V2xPriorityQueueDisc needs " << N_CLASSES << " internal queues");
+            return false;
+        }
+        return true;
+    }
+
+    void InitializeParams() override
+    {
+    }
+
+    uint32_t Limit(uint32_t c) const
+    {
+        return c == CLASS_BEACON ? m_beaconLimit : c == CLASS_DENM ? m_denmLimit : m_bulkLimit;
+    }
+
+    uint32_t m_beaconLimit{2};
+    uint32_t m_denmLimit{16};
+    uint32_t m_bulkLimit{100};
+    bool m_dropOldest{true};
+    uint64_t m_staleDrops{0};
+};
+
+NS_OBJECT_ENSURE_REGISTERED(V2xPriorityQueueDisc);
+
+} // namespace ns3
+
+#endif /* V2X_QUEUE_DISC_H */
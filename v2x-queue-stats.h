@@ -0,0 +1,186 @@
+/* v2x-queue-stats.h
+ *
+ * Aggregated queue statistics (--enableQueueTraces).
+ * - Per-device totals (enqueued, dequeued, dropped, requeued) read from
+ *   each root QueueDisc's own QueueDisc::Stats at the end of the run: no
+ *   callback per packet
+ * - One sampling event every --queueSampleInterval reads every qdisc's
+ *   backlog and adds it to a time-binned histogram with log2 buckets
+ *   (0, 1, 2-3, 4-7, ..., >= 2^(N_BUCKETS - 2)), plus a per-device peak and
+ *   mean backlog
+ * - Per-event enqueue/dequeue/drop records stay available as a debug mode,
+ *   connected only when the event log runs at LEVEL_QUEUE
+ *
+ * Output: <prefix>-queue.csv (one row per device) and
+ * <prefix>-queue-occupancy.csv (one row per time bin, devices per bucket).
+ */
+
+#ifndef V2X_QUEUE_STATS_H
+#define V2X_QUEUE_STATS_H
+
+#include "ns3/abort.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/queue-disc.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/traffic-control-layer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xQueueStats : public SimpleRefCount<V2xQueueStats>
+{
+  public:
+    static constexpr uint32_t N_BUCKETS = 8;
+
+    typedef void (*ItemSink)(Ptr<const QueueDiscItem>);
+
+    /// Devices with a root qdisc among `devices`; the rest are skipped.
+    void Attach(const NetDeviceContainer& devices)
+    {
+        for (uint32_t i = 0; i < devices.GetN(); ++i)
+        {
+            Ptr<NetDevice> dev = devices.Get(i);
+            Ptr<TrafficControlLayer> tc = dev->GetNode()->GetObject<TrafficControlLayer>();
+            Ptr<QueueDisc> qdisc = tc ? tc->GetRootQueueDiscOnDevice(dev) : nullptr;
+            if (qdisc)
+            {
+                m_qdiscs.push_back(qdisc);
+                m_devices.push_back(dev);
+            }
+        }
+        m_peak.assign(m_qdiscs.size(), 0);
+        m_backlogSum.assign(m_qdiscs.size(), 0);
+    }
+
+    /// Per-packet debug callbacks on every attached qdisc.
+    void ConnectEvents(ItemSink enqueue, ItemSink dequeue, ItemSink drop)
+    {
+        for (Ptr<QueueDisc> q : m_qdiscs)
+        {
+            q->TraceConnectWithoutContext("Enqueue", MakeCallback(enqueue));
+            q->TraceConnectWithoutContext("Dequeue", MakeCallback(dequeue));
+            q->TraceConnectWithoutContext("Drop", MakeCallback(drop));
+        }
+    }
+
+    void Start(Time interval)
+    {
+        NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(), "Queue sampling needs a positive interval");
+        m_interval = interval;
+        if (!m_qdiscs.empty())
+        {
+            Simulator::Schedule(interval, &V2xQueueStats::Sample, this);
+        }
+    }
+
+    uint32_t GetNDevices() const
+    {
+        return static_cast<uint32_t>(m_qdiscs.size());
+    }
+
+    uint64_t GetSamples() const
+    {
+        return m_bins.size();
+    }
+
+    uint64_t GetTotalDrops() const
+    {
+        uint64_t drops = 0;
+        for (Ptr<QueueDisc> q : m_qdiscs)
+        {
+            drops += q->GetStats().nTotalDroppedPackets;
+        }
+        return drops;
+    }
+
+    void Write(const std::string& prefix) const
+    {
+        std::ofstream dev(prefix + "-queue.csv");
+        NS_ABORT_MSG_IF(!dev.is_open(), "Cannot open " << prefix << "-queue.csv");
+        dev << "node,ifIndex,qdisc,enqueued,dequeued,requeued,dropped,peakPackets,meanPackets\n";
+        for (size_t i = 0; i < m_qdiscs.size(); ++i)
+        {
+            const QueueDisc::Stats& st = m_qdiscs[i]->GetStats();
+            dev << m_devices[i]->GetNode()->GetId() << ',' << m_devices[i]->GetIfIndex() << ','
+                << m_qdiscs[i]->GetInstanceTypeId().GetName() << ',' << st.nTotalEnqueuedPackets
+                << ',' << st.nTotalDequeuedPackets << ',' << st.nTotalRequeuedPackets << ','
+                << st.nTotalDroppedPackets << ',' << m_peak[i] << ','
+                << (m_bins.empty() ? 0.0 : double(m_backlogSum[i]) / m_bins.size()) << '\n';
+        }
+
+        std::ofstream occ(prefix + "-queue-occupancy.csv");
+        NS_ABORT_MSG_IF(!occ.is_open(), "Cannot open " << prefix << "-queue-occupancy.csv");
+        occ << "time_s,totalPackets";
+        for (uint32_t b = 0; b < N_BUCKETS; ++b)
+        {
+            occ << ",b" << BucketLow(b);
+        }
+        occ << '\n';
+        for (size_t t = 0; t < m_bins.size(); ++t)
+        {
+            occ << (m_interval * int64_t(t + 1)).GetSeconds() << ',' << m_totals[t];
+            for (uint32_t c : m_bins[t])
+            {
+                occ << ',' << c;
+            }
+            occ << '\n';
+        }
+    }
+
+  private:
+    /// Smallest backlog in bucket b.
+    static uint32_t BucketLow(uint32_t b)
+    {
+        return b == 0 ? 0 : 1u << (b - 1);
+    }
+
+    static uint32_t BucketOf(uint32_t packets)
+    {
+        uint32_t b = 0;
+        while (packets > 0 && b + 1 < N_BUCKETS)
+        {
+            packets >>= 1;
+            ++b;
+        }
+        return b;
+    }
+
+    void Sample()
+    {
+        std::array<uint32_t, N_BUCKETS> bin{};
+        uint64_t total = 0;
+        for (size_t i = 0; i < m_qdiscs.size(); ++i)
+        {
+            const uint32_t n = m_qdiscs[i]->GetNPackets();
+            ++bin[BucketOf(n)];
+            total += n;
+            m_peak[i] = std::max(m_peak[i], n);
+            m_backlogSum[i] += n;
+        }
+        m_bins.push_back(bin);
+        m_totals.push_back(total);
+        Simulator::Schedule(m_interval, &V2xQueueStats::Sample, this);
+    }
+
+    Time m_interval;
+    std::vector<Ptr<QueueDisc>> m_qdiscs;
+    std::vector<Ptr<NetDevice>> m_devices;
+    std::vector<uint32_t> m_peak;
+    std::vector<uint64_t> m_backlogSum;
+    std::vector<std::array<uint32_t, N_BUCKETS>> m_bins;
+    std::vector<uint64_t> m_totals;
+};
+
+} // namespace ns3
+
+#endif /* V2X_QUEUE_STATS_H */
@@ -0,0 +1,247 @@
+/* v2x-realtime.h
+ *
+ * Real-time emulation (--realtime).
+ * - Selects RealtimeSimulatorImpl with the HardLimit synchronization mode:
+ *   the run aborts once it falls more than --realtimeHardLimit behind the
+ *   wall clock; must be enabled before the first simulator call
+ * - V2xRealtimeMonitor: a probe event every --realtimeProbeInterval
+ *   measures the scheduling lag (wall clock minus simulated time) into a
+ *   log2 histogram in microseconds and counts lags above
+ *   --realtimeDeadline as missed deadlines
+ * - V2xCallbackBudget: wall time of a hot callback (ReceivePacket)
+ *   against a fixed budget, timed only in real-time mode
+ * - V2xTapGateway (needs the tap-bridge and csma modules): a ghost node
+ *   with a TapBridge in ConfigureLocal mode, wired to RSU 0 over CSMA on
+ *   10.2.0.0/24; the host side of the tap is 10.2.0.1 and takes RSU 0's
+ *   DATA, the vehicles route to it through RSU 0
+ *
+ * Output: <prefix>-rt-lag.csv (histogram), summary on stdout.
+ */
+
+#ifndef V2X_REALTIME_H
+#define V2X_REALTIME_H
+
+#include "ns3/abort.h"
+#include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#if __has_include("ns3/tap-bridge-module.h") && __has_include("ns3/csma-module.h")
+#include "ns3/csma-module.h"
+#include "ns3/tap-bridge-module.h"
+#define V2X_HAVE_TAP_BRIDGE 1
+#else
+#define V2X_HAVE_TAP_BRIDGE 0
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace ns3
+{
+
+class V2xRealtimeMonitor : public SimpleRefCount<V2xRealtimeMonitor>
+{
+  public:
+    static constexpr uint32_t N_BUCKETS = 16; //!< 0, 1, 2-3, ... >= 2^14 us
+
+    /// Select the real-time simulator; call before anything touches Simulator.
+    static void Enable(Time hardLimit)
+    {
+        NS_ABORT_MSG_IF(!hardLimit.IsStrictlyPositive(), "--realtimeHardLimit must be positive");
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::RealtimeSimulatorImpl"));
+        Config::SetDefault("ns3::RealtimeSimulatorImpl::SynchronizationMode",
+                           StringValue("HardLimit"));
+        Config::SetDefault("ns3::RealtimeSimulatorImpl::HardLimit", TimeValue(hardLimit));
+    }
+
+    void Start(Time probeInterval, Time deadline)
+    {
+        NS_ABORT_MSG_IF(!probeInterval.IsStrictlyPositive(),
+                        "--realtimeProbeInterval must be positive");
+        m_impl = DynamicCast<RealtimeSimulatorImpl>(Simulator::GetImplementation());
+        NS_ABORT_MSG_IF(!m_impl, "V2xRealtimeMonitor needs RealtimeSimulatorImpl");
+        m_interval = probeInterval;
+        m_deadline = deadline;
+        Simulator::Schedule(probeInterval, &V2xRealtimeMonitor::Probe, this);
+    }
+
+    uint64_t GetProbes() const
+    {
+        return m_probes;
+    }
+
+    uint64_t GetMissed() const
+    {
+        return m_missed;
+    }
+
+    void PrintStats(std::ostream& os) const
+    {
+        os << "Realtime: " << m_probes << " probes, " << m_missed << " missed the "
+           << m_deadline.GetMicroSeconds() << " us deadline, max lag " << m_maxLagUs
+           << " us, mean lag " << (m_probes ? m_lagSumUs / double(m_probes) : 0.0) << " us\n";
+    }
+
+    void Write(const std::string& prefix) const
+    {
+        std::ofstream os(prefix + "-rt-lag.csv");
+        NS_ABORT_MSG_IF(!os.is_open(), "Cannot open " << prefix << "-rt-lag.csv");
+        os << "lagFromUs,probes\n";
+        for (uint32_t b = 0; b < N_BUCKETS; ++b)
+        {
+            os << (b == 0 ? 0 : 1u << (b - 1)) << ',' << m_hist[b] << '\n';
+        }
+    }
+
+  private:
+    void Probe()
+    {
+        const int64_t lagUs =
+            std::max<int64_t>(0, (m_impl->RealtimeNow() - Simulator::Now()).GetMicroSeconds());
+        uint32_t b = 0;
+        for (int64_t v = lagUs; v > 0 && b + 1 < N_BUCKETS; v >>= 1)
+        {
+            ++b;
+        }
+        ++m_hist[b];
+        ++m_probes;
+        m_lagSumUs += lagUs;
+        m_maxLagUs = std::max(m_maxLagUs, lagUs);
+        if (MicroSeconds(lagUs) > m_deadline)
+        {
+            ++m_missed;
+        }
+        Simulator::Schedule(m_interval, &V2xRealtimeMonitor::Probe, this);
+    }
+
+    Ptr<RealtimeSimulatorImpl> m_impl;
+    Time m_interval;
+    Time m_deadline;
+    std::array<uint64_t, N_BUCKETS> m_hist{};
+    uint64_t m_probes{0};
+    uint64_t m_missed{0};
+    int64_t m_lagSumUs{0};
+    int64_t m_maxLagUs{0};
+};
+
+/// Wall time spent in a hot callback against a fixed budget.
+class V2xCallbackBudget
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    void Enable(std::chrono::nanoseconds budget)
+    {
+        m_enabled = true;
+        m_budget = budget;
+    }
+
+    bool IsEnabled() const
+    {
+        return m_enabled;
+    }
+
+    void Record(Clock::time_point start)
+    {
+        const std::chrono::nanoseconds d = Clock::now() - start;
+        ++m_calls;
+        m_total += d;
+        m_max = std::max(m_max, d);
+        if (d > m_budget)
+        {
+            ++m_over;
+        }
+    }
+
+    void PrintStats(std::ostream& os, const char* name) const
+    {
+        os << name << ": " << m_calls << " calls, mean "
+           << (m_calls ? m_total.count() / double(m_calls) : 0.0) << " ns, max " << m_max.count()
+           << " ns, " << m_over << " over the " << m_budget.count() << " ns budget\n";
+    }
+
+  private:
+    bool m_enabled{false};
+    std::chrono::nanoseconds m_budget{1000};
+    std::chrono::nanoseconds m_total{0};
+    std::chrono::nanoseconds m_max{0};
+    uint64_t m_calls{0};
+    uint64_t m_over{0};
+};
+
+#if V2X_HAVE_TAP_BRIDGE
+class V2xTapGateway : public SimpleRefCount<V2xTapGateway>
+{
+  public:
+    /// Ghost node + TapBridge `tapName`, linked to `rsu` over CSMA.
+    void Install(Ptr<Node> rsu, const std::string& tapName)
+    {
+        m_ghost = CreateObject<Node>();
+        CsmaHelper csma;
+        csma.SetChannelAttribute("DataRate", StringValue("1Gbps"));
+        csma.SetChannelAttribute("Delay", TimeValue(MicroSeconds(1)));
+        NetDeviceContainer devs = csma.Install(NodeContainer(m_ghost, rsu));
+        InternetStackHelper internet;
+        internet.Install(m_ghost);
+        Ipv4AddressHelper ipv4;
+        ipv4.SetBase("10.2.0.0", "255.255.255.0");
+        Ipv4InterfaceContainer ifs = ipv4.Assign(devs);
+        m_host = ifs.GetAddress(0);
+        m_rsuSide = ifs.GetAddress(1);
+
+        TapBridgeHelper tap;
+        tap.SetAttribute("Mode", StringValue("ConfigureLocal"));
+        tap.SetAttribute("DeviceName", StringValue(tapName));
+        tap.Install(m_ghost, devs.Get(0));
+    }
+
+    /// Route the tap subnet from each of `devices` (one per vehicle) via `gateway`.
+    void AddRoutes(const NetDeviceContainer& devices, uint32_t n, Ipv4Address gateway) const
+    {
+        Ipv4StaticRoutingHelper routing;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            Ptr<Ipv4> ip = devices.Get(i)->GetNode()->GetObject<Ipv4>();
+            routing.GetStaticRouting(ip)->AddNetworkRouteTo(Ipv4Address("10.2.0.0"),
+                                                            Ipv4Mask("255.255.255.0"),
+                                                            gateway,
+                                                            ip->GetInterfaceForDevice(devices.Get(i)));
+        }
+    }
+
+    Ipv4Address GetHostAddress() const
+    {
+        return m_host;
+    }
+
+    Ipv4Address GetRsuAddress() const
+    {
+        return m_rsuSide;
+    }
+
+  private:
+    Ptr<Node> m_ghost;
+    Ipv4Address m_host;
+    Ipv4Address m_rsuSide;
+};
+#endif
+
+} // namespace ns3
+
+#endif /* V2X_REALTIME_H */
@@ -0,0 +1,222 @@
+/* v2x-scenario.h
+ *
+ * Scenario configuration and per-run summary shared by the single-run
+ * entry point and the sweep driver.
+ */
+
+#ifndef V2X_SCENARIO_H
+#define V2X_SCENARIO_H
+
+#include "ns3/command-line.h"
+
+#include "v2x-event-log.h"
+#include "v2x-topology.h"
+#include "v2x-traits.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ns3
+{
+
+struct ScenarioConfig
+{
+    // --- outputs / tracing
+    bool enableFlowMonitor = true;
+    bool enablePcap = true;
+    std::string pcapNodes = "all";  //!< all | rsus | vehicles | comma list of node ids
+    uint32_t pcapSnaplen = 0;       //!< bytes kept per frame, 0 = whole frame
+    uint32_t pcapSample = 1;        //!< keep 1 in N frames per interface
+    std::string pcapFormat = "pcap"; //!< pcap (file per device) | pcapng (one file)
+    bool enableNetAnim = false;
+    bool enableQueueTraces = true;
+    double queueSampleInterval = 0.01; //!< queue backlog sampling period (s)
+    std::string queueDisc = "pfifoFast"; //!< keep | pfifoFast | fqCoDel | v2xPriority
+    std::string resultsFormat = "columnar"; //!< columnar | xml | both | none
+    std::string netAnimFile = "v2x-sim-netanim.xml";
+    std::string outputPrefix = "v2x-sim-final";
+    std::string snapshotSave; //!< write the post-setup snapshot here, empty = no
+    std::string snapshotLoad; //!< warm start from this snapshot, empty = build the setup
+    bool profile = false; //!< write <outputPrefix>-profile.json
+    double profileInterval = 0.1; //!< profile sampling period (simulated s)
+    bool realtime = false;                //!< RealtimeSimulatorImpl, HardLimit mode
+    double realtimeHardLimit = 0.1;       //!< abort when this far behind the wall clock (s)
+    double realtimeDeadline = 0.001;      //!< lag counted as a missed deadline (s)
+    double realtimeProbeInterval = 0.001; //!< lag probe period (s)
+    std::string tapDevice; //!< realtime: host TAP device for RSU 0's DATA, empty = none
+    uint32_t logLevel =
+        V2xScenarioTraits::EVENT_LOG ? V2xEventLog::LEVEL_APP : V2xEventLog::LEVEL_OFF;
+    uint32_t logSampleRate = 1;
+    std::string logFile; //!< empty = <outputPrefix>-events.csv
+    bool logBinary = false;
+    bool phyTrace = V2xScenarioTraits::PHY_TRACE; //!< binary PHY trace <outputPrefix>-phy.bin
+    bool asciiTrace = false; //!< full-text AsciiTraceHelper trace <outputPrefix>.tr
+    bool metrics = V2xScenarioTraits::METRICS;    //!< stamped PDR/latency/AoI metrics <outputPrefix>-metrics.csv
+    double statsInterval = 0.0; //!< online per-RSU stats window (s), 0 = off
+
+    // --- size / RNG
+    uint32_t nVehicles = 2;
+    double simTime = 12.0;
+    uint32_t rngRun = 1;
+    bool distributed = false;       //!< MPI: one spatial strip of vehicles per rank
+    double mpiBackhaulDelay = 0.001; //!< MPI: RSU backhaul delay = lookahead (s)
+
+    // --- topology / channel
+    V2xTopologyParams topo;
+    std::string mobilityTrace;  //!< SUMO FCD / ns-2 trace, empty = static topology
+    std::string mobilityFormat; //!< fcd | ns2, empty = by extension
+    double mobilityWindow = 10.0;
+    std::string channelModel = "yans";
+    std::string accessLayer = "wifi"; //!< wifi | sidelink (C-V2X Mode 4 SPS)
+    std::string wifiMode = "adhoc"; //!< adhoc (802.11a, 20 MHz) | ocb (802.11p, 10 MHz)
+    uint32_t nServiceChannels = 0;  //!< ocb: service channels for vehicle DATA, 0 = CCH only
+    uint32_t slSubchannels = 3;     //!< sidelink: subchannels per 1 ms subframe
+    uint32_t slReservation = 100;   //!< sidelink: SPS reservation interval (ms)
+    double maxRange = 0.0;
+    bool positionCache = true; //!< channel/association read a per-timestamp position store
+    std::string lossModel = "logDistance"; //!< logDistance (analytic) | table (V2xTabulatedLossModel)
+    uint32_t lossTableBits = 5;            //!< table: mantissa bits of d^2 per bin
+    std::string arpMode = "perNode"; //!< perNode (cache per vehicle) | shared (one table)
+    uint32_t nRsus = 1;
+    double associationInterval = 1.0; //!< nearest-RSU re-evaluation period (s), 0 = never
+    double handoverHysteresis = 5.0;  //!< hand over only if closer by this much (m)
+
+    // --- traffic
+    std::string trafficMode = "scheduled";
+    double beaconInterval = 0.1;
+    uint32_t beaconPayload = 100;
+    double dataInterval = 0.0;
+    std::string sendScheduler = "perVehicle";
+    double batchSlot = 0.001;
+    double sendStart = 1.0;
+    double sendStagger = 1.0;
+    double sendInterval = 1.0;
+    uint32_t nSends = 2;
+    double sendJitter = 0.0;
+    std::string payloadPattern; //!< payload content repeated, empty = zero-filled
+    std::string dcc = "off";  //!< off | reactive | limeric (ETSI TS 102 687)
+    double dccInterval = 0.1; //!< DCC evaluation / CBR measurement period (s)
+    double v2vInterval = 0.0;         //!< V2V geo-broadcast period (s), 0 = off
+    uint32_t v2vPayload = 200;        //!< V2V payload after the geo header (bytes)
+    uint32_t v2vMaxHops = 3;          //!< hop limit, 1 = single-hop broadcast
+    double v2vAreaRadius = 500.0;     //!< destination area around the originator (m)
+    double v2vContention = 0.05;      //!< longest relay contention timer (s)
+    double v2vContentionRange = 300;  //!< distance from the last sender with a zero timer (m)
+    uint32_t v2vDuplicateSlots = 256; //!< duplicate ring size per vehicle
+
+    void AddToCommandLine(CommandLine& cmd)
+    {
+        cmd.AddValue("enableFlowMonitor", "Enable FlowMonitor", enableFlowMonitor);
+        cmd.AddValue("enablePcap", "Enable PCAP capture", enablePcap);
+        cmd.AddValue("pcapNodes", "PCAP: capture nodes all | rsus | vehicles | comma list of node ids", pcapNodes);
+        cmd.AddValue("pcapSnaplen", "PCAP: bytes kept per frame (0 = whole frame)", pcapSnaplen);
+        cmd.AddValue("pcapSample", "PCAP: keep 1 in N frames per interface", pcapSample);
+        cmd.AddValue("pcapFormat", "PCAP: pcap (one file per device) | pcapng (all interfaces, one buffered file)", pcapFormat);
+        cmd.AddValue("enableNetAnim", "Enable NetAnim XML output", enableNetAnim);
+        cmd.AddValue("enableQueueTraces", "Enable queue statistics (per-packet records need logLevel=2)", enableQueueTraces);
+        cmd.AddValue("queueSampleInterval", "Queue backlog sampling period (s)", queueSampleInterval);
+        cmd.AddValue("queueDisc", "Root qdisc: keep (Assign's default) | pfifoFast | fqCoDel | v2xPriority (beacon/DENM/bulk)", queueDisc);
+        cmd.AddValue("netAnimFile", "NetAnim filename", netAnimFile);
+        cmd.AddValue("resultsFormat", "End-of-run results: columnar (<outputPrefix>-results.v2xcol) | xml | both | none", resultsFormat);
+        cmd.AddValue("outputPrefix", "Prefix of PCAP/trace/FlowMonitor/log files", outputPrefix);
+        cmd.AddValue("snapshotSave", "Save the post-setup scenario snapshot to this file", snapshotSave);
+        cmd.AddValue("snapshotLoad", "Warm start: restore positions/partition/association/addresses from a snapshot", snapshotLoad);
+        cmd.AddValue("profile", "Profile phases, event rate, scheduler depth and peak RSS", profile);
+        cmd.AddValue("profileInterval", "Profile sampling period (simulated s)", profileInterval);
+        cmd.AddValue("realtime", "Real-time emulation: RealtimeSimulatorImpl in HardLimit mode", realtime);
+        cmd.AddValue("realtimeHardLimit", "realtime: abort when this far behind the wall clock (s)", realtimeHardLimit);
+        cmd.AddValue("realtimeDeadline", "realtime: scheduling lag counted as a missed deadline (s)", realtimeDeadline);
+        cmd.AddValue("realtimeProbeInterval", "realtime: lag probe period (s)", realtimeProbeInterval);
+        cmd.AddValue("tapDevice", "realtime: TAP device whose host side replaces RSU 0 as DATA sink", tapDevice);
+        cmd.AddValue("nVehicles", "Number of vehicle nodes", nVehicles);
+        cmd.AddValue("simTime", "Simulation stop time (s)", simTime);
+        cmd.AddValue("rngRun", "RNG run number", rngRun);
+        cmd.AddValue("distributed", "MPI: partition vehicles into spatial strips, one per rank", distributed);
+        cmd.AddValue("mpiBackhaulDelay", "MPI: RSU backhaul delay, i.e. the lookahead (s)", mpiBackhaulDelay);
+        cmd.AddValue("logLevel", "Event log level (0=off, 1=app TX/RX, 2=+queue events)", logLevel);
+        cmd.AddValue("logSampleRate", "Record 1 in N events of each type that pass logLevel", logSampleRate);
+        cmd.AddValue("logFile", "Event log filename (default <outputPrefix>-events.csv)", logFile);
+        cmd.AddValue("logBinary", "Write the event log as binary records instead of CSV", logBinary);
+        cmd.AddValue("phyTrace", "Write the binary PHY trace <outputPrefix>-phy.bin", phyTrace);
+        cmd.AddValue("asciiTrace", "Write the full-text ASCII trace <outputPrefix>.tr", asciiTrace);
+        cmd.AddValue("metrics", "Stamp DATA payloads and collect PDR/latency/AoI per vehicle", metrics);
+        cmd.AddValue("statsInterval", "Append per-RSU PDR/latency/throughput/CBR to <outputPrefix>-online.csv every this many s (0 = off)", statsInterval);
+        cmd.AddValue("topology", "Vehicle layout: line|grid|highway|manhattan", topo.layout);
+        cmd.AddValue("spacing", "Distance between neighbouring vehicles (m)", topo.spacing);
+        cmd.AddValue("gridColumns", "grid: number of columns (0 = square)", topo.gridColumns);
+        cmd.AddValue("nLanes", "highway: number of lanes", topo.nLanes);
+        cmd.AddValue("laneWidth", "highway / manhattan: lane width (m)", topo.laneWidth);
+        cmd.AddValue("nStreets", "manhattan: streets per direction", topo.nStreets);
+        cmd.AddValue("blockSize", "manhattan: block size (m)", topo.blockSize);
+        cmd.AddValue("mobilityTrace", "SUMO FCD (.xml) or ns-2 mobility trace, streamed; empty = static topology", mobilityTrace);
+        cmd.AddValue("mobilityFormat", "Mobility trace format: fcd|ns2 (default: by extension)", mobilityFormat);
+        cmd.AddValue("mobilityWindow", "Mobility trace read-ahead window (s)", mobilityWindow);
+        cmd.AddValue("accessLayer", "Radio access: wifi (see --wifiMode) | sidelink (LTE-V2X Mode 4, SPS)", accessLayer);
+        cmd.AddValue("slSubchannels", "sidelink: subchannels per subframe", slSubchannels);
+        cmd.AddValue("slReservation", "sidelink: SPS reservation interval (ms)", slReservation);
+        cmd.AddValue("wifiMode", "MAC/PHY: adhoc (802.11a AdhocWifiMac) | ocb (802.11p OCB, 10 MHz)", wifiMode);
+        cmd.AddValue("nServiceChannels", "ocb: service channels (0-6) that carry vehicle DATA; beacons stay on the CCH", nServiceChannels);
+        cmd.AddValue("channelModel", "Wifi channel: yans (all receivers) | grid (spatial index)", channelModel);
+        cmd.AddValue("maxRange", "grid channel: receiver cutoff (m), 0 = RX sensitivity range", maxRange);
+        cmd.AddValue("lossModel", "Path loss: logDistance (analytic) | table (tabulated, bounded error)", lossModel);
+        cmd.AddValue("lossTableBits", "table: mantissa bits of d^2 per bin (max error 7.9e-4 dB at 5)", lossTableBits);
+        cmd.AddValue("positionCache", "grid channel / association: cache positions per timestamp", positionCache);
+        cmd.AddValue("arpMode", "ARP pre-population: perNode (RSU entry per vehicle) | shared (one table for all nodes)", arpMode);
+        cmd.AddValue("nRsus", "Number of RSUs, spread along the vehicle layout", nRsus);
+        cmd.AddValue("associationInterval", "nRsus>1: nearest-RSU re-evaluation period (s), 0 = never", associationInterval);
+        cmd.AddValue("handoverHysteresis", "nRsus>1: hand over only when another RSU is closer by this much (m)", handoverHysteresis);
+        cmd.AddValue("trafficMode", "scheduled (fixed sends per vehicle) | beacon (RSU beacon apps)", trafficMode);
+        cmd.AddValue("beaconInterval", "beacon: RSU beacon period (s)", beaconInterval);
+        cmd.AddValue("beaconPayload", "beacon: beacon/DATA payload (64|100|200|300|500|1000 bytes)", beaconPayload);
+        cmd.AddValue("dataInterval", "beacon: vehicle DATA period after reacting (s), 0 = none", dataInterval);
+        cmd.AddValue("sendScheduler", "scheduled: perVehicle (event per vehicle, exact times) | batched (event per slot, times rounded to --batchSlot)", sendScheduler);
+        cmd.AddValue("batchSlot", "batched: slot width (s); first sends and intervals are rounded to it", batchSlot);
+        cmd.AddValue("sendStart", "scheduled: first send of vehicle 0 (s)", sendStart);
+        cmd.AddValue("sendStagger", "scheduled: first-send offset between consecutive vehicles (s)", sendStagger);
+        cmd.AddValue("sendInterval", "scheduled: interval between a vehicle's sends (s)", sendInterval);
+        cmd.AddValue("nSends", "scheduled: sends per vehicle, 0 = until simTime", nSends);
+        cmd.AddValue("sendJitter", "scheduled: deterministic per-vehicle first-send jitter (s)", sendJitter);
+        cmd.AddValue("payloadPattern", "Payload bytes (repeated) of every sent packet, empty = zero-filled", payloadPattern);
+        cmd.AddValue("dcc", "Congestion control: off | reactive (5-state, interval/power/rate) | limeric (duty cycle, max duty = configured interval)", dcc);
+        cmd.AddValue("dccInterval", "DCC evaluation period (s)", dccInterval);
+        cmd.AddValue("v2vInterval", "V2V geo-broadcast period per vehicle (s), 0 = off", v2vInterval);
+        cmd.AddValue("v2vPayload", "V2V payload after the geo header (bytes)", v2vPayload);
+        cmd.AddValue("v2vMaxHops", "V2V hop limit (1 = no relaying)", v2vMaxHops);
+        cmd.AddValue("v2vAreaRadius", "V2V destination area radius around the originator (m)", v2vAreaRadius);
+        cmd.AddValue("v2vContention", "V2V longest relay contention timer (s)", v2vContention);
+        cmd.AddValue("v2vContentionRange", "V2V distance from the last sender at which the relay timer is zero (m)", v2vContentionRange);
+        cmd.AddValue("v2vDuplicateSlots", "V2V duplicate ring size per vehicle (>= neighbours x rate x hops x contention)", v2vDuplicateSlots);
+    }
+};
+
+/// Summary of one run; plain data so it can be passed through a pipe.
+struct ScenarioResult
+{
+    uint32_t nVehicles = 0;
+    double simTime = 0;
+    uint32_t rngRun = 0;
+    uint64_t txPackets = 0;      //!< application packets sent by vehicles
+    uint64_t rxPackets = 0;      //!< application packets received at the RSU
+    uint64_t rxBytes = 0;
+    uint64_t beaconPackets = 0;  //!< RSU beacons sent (beacon mode), not in txPackets
+    double meanDelayMs = 0;      //!< FlowMonitor mean one-way delay, 0 without FlowMonitor
+    double latencyP50Ms = 0;     //!< stamped-payload latency percentiles, 0 without --metrics
+    double latencyP95Ms = 0;
+    double latencyP99Ms = 0;
+    double meanAoiMs = 0;        //!< time-average age of information over all vehicles
+    uint64_t events = 0;         //!< simulator events executed
+    double wallSeconds = 0;      //!< setup + run wall time
+    double runSeconds = 0;       //!< wall time of Simulator::Run() alone
+    uint64_t peakRssKb = 0;      //!< peak resident set size of the process (KiB)
+
+    double GetPdr() const
+    {
+        return txPackets ? double(rxPackets) / double(txPackets) : 0.0;
+    }
+};
+
+ScenarioResult RunScenario(const ScenarioConfig& cfg);
+
+} // namespace ns3
+
+#endif /* V2X_SCENARIO_H */
@@ -0,0 +1,313 @@
+/* v2x-send-scheduler.h
+ *
+ * Periodic vehicle send scheduling.
+ * - perVehicle: one chained event per vehicle (N pending events)
+ * - batched:    one tick event per slot walking a hashed timing wheel of
+ *               vehicle indices; every send due in that slot is issued from
+ *               the same event
+ *
+ * Both take the same plan (first send, interval, number of sends) and the
+ * same deterministic per-vehicle jitter, but they do not send at the same
+ * times: batched rounds each vehicle's first send (jitter included) and
+ * every interval, its DCC updates as well, to the nearest slot, so a
+ * jitter below half a slot is lost and intervals are whole slots. With a
+ * slot that divides the interval and the jitter grain, both match.
+ */
+
+#ifndef V2X_SEND_SCHEDULER_H
+#define V2X_SEND_SCHEDULER_H
+
+#include "ns3/abort.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xSendScheduler : public SimpleRefCount<V2xSendScheduler>
+{
+  public:
+    typedef std::function<void(uint32_t)> SendCallback;
+
+    virtual ~V2xSendScheduler() = default;
+
+    void SetSendCallback(SendCallback cb)
+    {
+        m_send = std::move(cb);
+    }
+
+    /// Offsets every vehicle's first send by a fixed pseudo-random amount in [0, jitter).
+    void SetJitter(Time jitter)
+    {
+        m_jitter = jitter;
+    }
+
+    /**
+     * Register vehicle `idx`: first send at `start` (plus jitter), then one
+     * every `interval`, `count` sends in total (0 = until the simulation stops).
+     */
+    virtual void Add(uint32_t idx, Time start, Time interval, uint32_t count) = 0;
+
+    /// Schedule the first event(s); call once after all Add()s.
+    virtual void Start() = 0;
+
+    /// Change vehicle `idx`'s interval; takes effect after its next send (DCC).
+    virtual void SetInterval(uint32_t idx, Time interval) = 0;
+
+    virtual std::string GetName() const = 0;
+
+    /// Number of sends issued so far.
+    uint64_t GetSends() const
+    {
+        return m_sends;
+    }
+
+    /// Number of scheduler events executed so far.
+    uint64_t GetEvents() const
+    {
+        return m_events;
+    }
+
+  protected:
+    Time JitterFor(uint32_t idx) const
+    {
+        if (!m_jitter.IsStrictlyPositive())
+        {
+            return TimeStep(0);
+        }
+        // splitmix64 step: stable across runs and platforms
+        uint64_t z = idx + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        return TimeStep(z % static_cast<uint64_t>(m_jitter.GetTimeStep()));
+    }
+
+    void DoSend(uint32_t idx)
+    {
+        ++m_sends;
+        m_send(idx);
+    }
+
+    SendCallback m_send;
+    Time m_jitter;
+    uint64_t m_sends{0};
+    uint64_t m_events{0};
+};
+
+class PerVehicleSendScheduler : public V2xSendScheduler
+{
+  public:
+    void Add(uint32_t idx, Time start, Time interval, uint32_t count) override
+    {
+        if (idx >= m_state.size())
+        {
+            m_state.resize(idx + 1);
+        }
+        m_state[idx] = {start + JitterFor(idx), interval, count == 0 ? UINT32_MAX : count};
+    }
+
+    void Start() override
+    {
+        for (uint32_t i = 0; i < m_state.size(); ++i)
+        {
+            if (m_state[i].remaining > 0)
+            {
+                Simulator::Schedule(m_state[i].start, &PerVehicleSendScheduler::Fire, this, i);
+            }
+        }
+    }
+
+    void SetInterval(uint32_t idx, Time interval) override
+    {
+        m_state[idx].interval = interval;
+    }
+
+    std::string GetName() const override
+    {
+        return "perVehicle";
+    }
+
+  private:
+    struct State
+    {
+        Time start;
+        Time interval;
+        uint32_t remaining{0};
+    };
+
+    void Fire(uint32_t idx)
+    {
+        ++m_events;
+        DoSend(idx);
+        State& s = m_state[idx];
+        if (s.remaining != UINT32_MAX)
+        {
+            --s.remaining;
+        }
+        if (s.remaining > 0)
+        {
+            Simulator::Schedule(s.interval, &PerVehicleSendScheduler::Fire, this, idx);
+        }
+    }
+
+    std::vector<State> m_state;
+};
+
+class BatchedSendScheduler : public V2xSendScheduler
+{
+  public:
+    explicit BatchedSendScheduler(Time slot)
+        : m_slot(slot)
+    {
+        NS_ABORT_MSG_IF(!slot.IsStrictlyPositive(), "Batched send scheduler needs a positive slot");
+    }
+
+    void Add(uint32_t idx, Time start, Time interval, uint32_t count) override
+    {
+        if (idx >= m_state.size())
+        {
+            m_state.resize(idx + 1);
+        }
+        State& s = m_state[idx];
+        s.due = ToSlot(start + JitterFor(idx));
+        s.interval = std::max<uint64_t>(1, ToSlot(interval));
+        s.remaining = count == 0 ? UINT32_MAX : count;
+        m_maxInterval = std::max(m_maxInterval, s.interval);
+    }
+
+    void Start() override
+    {
+        // wheel covers the longest interval, so a re-armed vehicle lands at
+        // most one revolution ahead; later first sends just wait extra rounds
+        uint64_t size = 64;
+        while (size <= m_maxInterval)
+        {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_wheel.assign(size, {});
+        uint64_t first = UINT64_MAX;
+        for (uint32_t i = 0; i < m_state.size(); ++i)
+        {
+            if (m_state[i].remaining == 0)
+            {
+                continue;
+            }
+            m_wheel[m_state[i].due & m_mask].push_back(i);
+            first = std::min(first, m_state[i].due);
+            ++m_pending;
+        }
+        if (m_pending > 0)
+        {
+            m_current = first;
+            Simulator::Schedule(TimeStep(m_slot.GetTimeStep() * first) - Simulator::Now(),
+                                &BatchedSendScheduler::Tick,
+                                this);
+        }
+    }
+
+    void SetInterval(uint32_t idx, Time interval) override
+    {
+        // may exceed the wheel: Tick() keeps entries due in a later revolution
+        m_state[idx].interval = std::max<uint64_t>(1, ToSlot(interval));
+    }
+
+    std::string GetName() const override
+    {
+        return "batched";
+    }
+
+  private:
+    struct State
+    {
+        uint64_t due{0};      //!< slot of the next send
+        uint64_t interval{1}; //!< interval in slots
+        uint32_t remaining{0};
+    };
+
+    uint64_t ToSlot(Time t) const
+    {
+        return static_cast<uint64_t>((t.GetTimeStep() + m_slot.GetTimeStep() / 2) /
+                                     m_slot.GetTimeStep());
+    }
+
+    void Tick()
+    {
+        ++m_events;
+        std::vector<uint32_t>& bucket = m_wheel[m_current & m_mask];
+        m_scratch.swap(bucket);
+        for (uint32_t idx : m_scratch)
+        {
+            State& s = m_state[idx];
+            if (s.due != m_current)
+            {
+                bucket.push_back(idx); // due in a later revolution
+                continue;
+            }
+            DoSend(idx);
+            if (s.remaining != UINT32_MAX)
+            {
+                --s.remaining;
+            }
+            if (s.remaining == 0)
+            {
+                --m_pending;
+                continue;
+            }
+            s.due += s.interval;
+            m_wheel[s.due & m_mask].push_back(idx);
+        }
+        m_scratch.clear();
+        if (m_pending == 0)
+        {
+            return;
+        }
+        // skip empty buckets so idle stretches cost no events
+        uint64_t next = m_current + 1;
+        while (m_wheel[next & m_mask].empty())
+        {
+            ++next;
+        }
+        Simulator::Schedule(TimeStep(m_slot.GetTimeStep() * (next - m_current)),
+                            &BatchedSendScheduler::Tick,
+                            this);
+        m_current = next;
+    }
+
+    Time m_slot;
+    uint64_t m_mask{0};
+    uint64_t m_maxInterval{1};
+    uint64_t m_current{0};
+    uint64_t m_pending{0};
+    std::vector<State> m_state;
+    std::vector<std::vector<uint32_t>> m_wheel;
+    std::vector<uint32_t> m_scratch;
+};
+
+inline Ptr<V2xSendScheduler>
+CreateSendScheduler(const std::string& kind, Time slot)
+{
+    if (kind == "perVehicle")
+    {
+        return Create<PerVehicleSendScheduler>();
+    }
+    if (kind == "batched")
+    {
+        return Create<BatchedSendScheduler>(slot);
+    }
+    NS_FATAL_ERROR("Unknown sendScheduler '" << kind << "' (perVehicle|batched)");
+    return nullptr;
+}
+
+} // namespace ns3
+
+#endif /* V2X_SEND_SCHEDULER_H */
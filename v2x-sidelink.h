@@ -0,0 +1,949 @@
+/* v2x-sidelink.h
+ *
+ * Simplified LTE-V2X sidelink Mode 4 access layer (--accessLayer=sidelink).
+ * - 1 ms subframes with NumSubchannels subchannels of SubchannelBytes each;
+ *   a packet occupies ceil(size / SubchannelBytes) adjacent subchannels
+ * - Semi-persistent scheduling: a device reserves (subframe, subchannels)
+ *   every ReservationInterval and keeps the reservation for a reselection
+ *   counter of 5-15 transmissions, then again with ProbResourceKeep
+ * - Sensing-based selection (TS 36.213 14.1.1.6, simplified): candidates
+ *   overlapping a neighbour reservation decoded in the last 1000 ms with
+ *   RSRP above SensingThreshold are excluded (threshold +3 dB until 20% of
+ *   the candidates remain), then one is picked at random among the 20%
+ *   with the lowest average S-RSSI
+ * - The channel resolves a subframe in one pass at its end: half duplex,
+ *   SINR against every overlapping transmission, RX sensitivity; batches
+ *   are kept per subframe, so a transmission starting at the same instant
+ *   the previous subframe is resolved never joins that batch
+ * - Channel busy ratio per device: share of subchannels over the last 100
+ *   subframes whose S-RSSI exceeded CbrThreshold
+ * - Only subframes with something audible are reported to a device; the
+ *   idle ones in between count as noise-only S-RSSI in the averages (aged
+ *   in closed form when the cell is next read or written) and as idle
+ *   subchannels in the CBR window
+ *
+ * Not modelled: HARQ blind retransmissions, a separate PSCCH (the SCI is
+ * decoded with the data), MCS / TB size beyond the subchannel capacity,
+ * and traffic above one packet per reservation interval (it queues).
+ * Devices use ARP like any broadcast medium: unicast frames carry the
+ * next-hop MAC and other receivers drop them at L2 (PACKET_OTHERHOST), so
+ * nothing is forwarded again by vehicles that merely overheard it.
+ */
+
+#ifndef V2X_SIDELINK_H
+#define V2X_SIDELINK_H
+
+#include "ns3/abort.h"
+#include "ns3/channel.h"
+#include "ns3/double.h"
+#include "ns3/mac48-address.h"
+#include "ns3/mobility-model.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/pointer.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/traced-callback.h"
+#include "ns3/uinteger.h"
+
+#include "v2x-position-store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xSidelinkNetDevice;
+
+class V2xSidelinkChannel : public Channel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::V2xSidelinkChannel")
+                .SetParent<Channel>()
+                .SetGroupName("Network")
+                .AddConstructor<V2xSidelinkChannel>()
+                .AddAttribute("NumSubchannels",
+                              "Subchannels per subframe",
+                              UintegerValue(3),
+                              MakeUintegerAccessor(&V2xSidelinkChannel::m_nSub),
+                              MakeUintegerChecker<uint32_t>(1, 64))
+                .AddAttribute("SubchannelBytes",
+                              "Payload bytes one subchannel carries per subframe",
+                              UintegerValue(190),
+                              MakeUintegerAccessor(&V2xSidelinkChannel::m_subchannelBytes),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("NoiseDbm",
+                              "Noise power per subchannel (dBm)",
+                              DoubleValue(-102.4),
+                              MakeDoubleAccessor(&V2xSidelinkChannel::m_noiseDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("RxSensitivity",
+                              "Per-packet received power below which nothing is decoded (dBm)",
+                              DoubleValue(-95.0),
+                              MakeDoubleAccessor(&V2xSidelinkChannel::m_sensitivityDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("SinrThreshold",
+                              "Minimum average SINR for a successful decode (dB)",
+                              DoubleValue(3.0),
+                              MakeDoubleAccessor(&V2xSidelinkChannel::m_sinrThresholdDb),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("CbrThreshold",
+                              "S-RSSI above which a subchannel counts as busy (dBm)",
+                              DoubleValue(-94.0),
+                              MakeDoubleAccessor(&V2xSidelinkChannel::m_cbrThresholdDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("MaxRange",
+                              "Receivers farther than this are not evaluated (m), 0 = all",
+                              DoubleValue(0.0),
+                              MakeDoubleAccessor(&V2xSidelinkChannel::m_maxRange),
+                              MakeDoubleChecker<double>(0.0));
+        return tid;
+    }
+
+    void SetPropagationLossModel(Ptr<PropagationLossModel> loss)
+    {
+        m_loss = loss;
+    }
+
+    /// Positions from `store`, and with `lossDb(d2)` no mobility model calls.
+    void SetPositionStore(Ptr<V2xPositionStore> store, std::function<double(double)> lossDb)
+    {
+        m_store = store;
+        m_distanceLoss = std::move(lossDb);
+    }
+
+    void Add(Ptr<V2xSidelinkNetDevice> dev);
+
+    std::size_t GetNDevices() const override
+    {
+        return m_devices.size();
+    }
+
+    Ptr<NetDevice> GetDevice(std::size_t i) const override;
+
+    uint32_t GetNSubchannels() const
+    {
+        return m_nSub;
+    }
+
+    /// Subchannels a packet of `bytes` needs, 0 if it does not fit a subframe.
+    uint32_t SubchannelsFor(uint32_t bytes) const
+    {
+        const uint32_t n = (bytes + m_subchannelBytes - 1) / m_subchannelBytes;
+        return n <= m_nSub ? std::max(n, 1u) : 0;
+    }
+
+    uint32_t GetSubchannelBytes() const
+    {
+        return m_subchannelBytes;
+    }
+
+    double GetSensitivityDbm() const
+    {
+        return m_sensitivityDbm;
+    }
+
+    double GetNoiseMw() const
+    {
+        return std::pow(10.0, m_noiseDbm / 10.0);
+    }
+
+    /// Start a transmission in the current subframe; resolved at its end.
+    void Transmit(Ptr<V2xSidelinkNetDevice> dev,
+                  Ptr<Packet> p,
+                  Mac48Address dst,
+                  uint16_t protocol,
+                  uint32_t firstSub,
+                  uint32_t nSub);
+
+    struct Stats
+    {
+        uint64_t transmissions{0};
+        uint64_t received{0};       //!< (transmission, receiver) pairs decoded
+        uint64_t sinrFailures{0};   //!< above sensitivity but below the SINR threshold
+        uint64_t halfDuplex{0};     //!< in-range receiver was transmitting itself
+    };
+
+    const Stats& GetStats() const
+    {
+        return m_stats;
+    }
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    struct Tx
+    {
+        Ptr<V2xSidelinkNetDevice> dev;
+        Ptr<Packet> p;
+        Mac48Address dst;
+        uint16_t protocol;
+        uint32_t firstSub;
+        uint32_t nSub;
+    };
+
+    void Resolve(int64_t sf);
+
+    std::vector<Ptr<V2xSidelinkNetDevice>> m_devices;
+    std::map<int64_t, std::vector<Tx>> m_pending; //!< by subframe (ms)
+    Ptr<PropagationLossModel> m_loss;
+    Ptr<V2xPositionStore> m_store;
+    std::function<double(double)> m_distanceLoss;
+    uint32_t m_nSub{3};
+    uint32_t m_subchannelBytes{190};
+    double m_noiseDbm{-102.4};
+    double m_sensitivityDbm{-95.0};
+    double m_sinrThresholdDb{3.0};
+    double m_cbrThresholdDbm{-94.0};
+    double m_maxRange{0.0};
+    Stats m_stats;
+    // per-Resolve scratch, kept to avoid reallocating every subframe
+    std::vector<double> m_rxMw;
+    std::vector<double> m_subMw;
+    std::vector<Vector> m_txPos;
+    std::vector<uint32_t> m_txSlot;
+    std::vector<Ptr<MobilityModel>> m_txMobility;
+};
+
+class V2xSidelinkNetDevice : public NetDevice
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::V2xSidelinkNetDevice")
+                .SetParent<NetDevice>()
+                .SetGroupName("Network")
+                .AddConstructor<V2xSidelinkNetDevice>()
+                .AddAttribute("Mtu",
+                              "MAC-level maximum transmission unit",
+                              UintegerValue(1500),
+                              MakeUintegerAccessor(&V2xSidelinkNetDevice::m_mtu),
+                              MakeUintegerChecker<uint16_t>())
+                .AddAttribute("TxPower",
+                              "Transmission power (dBm)",
+                              DoubleValue(23.0),
+                              MakeDoubleAccessor(&V2xSidelinkNetDevice::m_txPowerDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("ReservationInterval",
+                              "SPS resource reservation interval (whole ms)",
+                              TimeValue(MilliSeconds(100)),
+                              MakeTimeAccessor(&V2xSidelinkNetDevice::m_rri),
+                              MakeTimeChecker(MilliSeconds(1)))
+                .AddAttribute("ProbResourceKeep",
+                              "Probability of keeping the reservation when the counter expires",
+                              DoubleValue(0.8),
+                              MakeDoubleAccessor(&V2xSidelinkNetDevice::m_probKeep),
+                              MakeDoubleChecker<double>(0.0, 1.0))
+                .AddAttribute("ReselectAfter",
+                              "Release the reservation after this many unused occasions",
+                              UintegerValue(5),
+                              MakeUintegerAccessor(&V2xSidelinkNetDevice::m_reselectAfter),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("SensingThreshold",
+                              "Initial RSRP exclusion threshold (dBm)",
+                              DoubleValue(-110.0),
+                              MakeDoubleAccessor(&V2xSidelinkNetDevice::m_sensingThresholdDbm),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("QueueSize",
+                              "Packets waiting for the next reserved subframe",
+                              UintegerValue(10),
+                              MakeUintegerAccessor(&V2xSidelinkNetDevice::m_queueSize),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddTraceSource("PhyTx",
+                                "Packet sent on the sidelink",
+                                MakeTraceSourceAccessor(&V2xSidelinkNetDevice::m_phyTx),
+                                "ns3::Packet::TracedCallback")
+                .AddTraceSource("PhyRxOk",
+                                "Packet decoded from the sidelink",
+                                MakeTraceSourceAccessor(&V2xSidelinkNetDevice::m_phyRxOk),
+                                "ns3::Packet::TracedCallback")
+                .AddTraceSource("PhyRxDrop",
+                                "Packet above sensitivity lost to interference",
+                                MakeTraceSourceAccessor(&V2xSidelinkNetDevice::m_phyRxDrop),
+                                "ns3::Packet::TracedCallback")
+                .AddTraceSource("MacTxDrop",
+                                "Packet dropped because the SPS queue was full or it was too large",
+                                MakeTraceSourceAccessor(&V2xSidelinkNetDevice::m_macTxDrop),
+                                "ns3::Packet::TracedCallback");
+        return tid;
+    }
+
+    V2xSidelinkNetDevice()
+    {
+        m_rng = CreateObject<UniformRandomVariable>();
+    }
+
+    void SetChannel(Ptr<V2xSidelinkChannel> channel)
+    {
+        m_channel = channel;
+        channel->Add(this);
+    }
+
+    int64_t AssignStreams(int64_t stream)
+    {
+        m_rng->SetStream(stream);
+        return 1;
+    }
+
+    // --- NetDevice
+    void SetIfIndex(const uint32_t index) override
+    {
+        m_ifIndex = index;
+    }
+
+    uint32_t GetIfIndex() const override
+    {
+        return m_ifIndex;
+    }
+
+    Ptr<Channel> GetChannel() const override
+    {
+        return m_channel;
+    }
+
+    void SetAddress(Address address) override
+    {
+        m_address = Mac48Address::ConvertFrom(address);
+    }
+
+    Address GetAddress() const override
+    {
+        return m_address;
+    }
+
+    bool SetMtu(const uint16_t mtu) override
+    {
+        m_mtu = mtu;
+        return true;
+    }
+
+    uint16_t GetMtu() const override
+    {
+        return m_mtu;
+    }
+
+    bool IsLinkUp() const override
+    {
+        return true;
+    }
+
+    void AddLinkChangeCallback(Callback<void>) override
+    {
+    }
+
+    bool IsBroadcast() const override
+    {
+        return true;
+    }
+
+    Address GetBroadcast() const override
+    {
+        return Mac48Address::GetBroadcast();
+    }
+
+    bool IsMulticast() const override
+    {
+        return true;
+    }
+
+    Address GetMulticast(Ipv4Address group) const override
+    {
+        return Mac48Address::GetMulticast(group);
+    }
+
+    Address GetMulticast(Ipv6Address group) const override
+    {
+        return Mac48Address::GetMulticast(group);
+    }
+
+    bool IsBridge() const override
+    {
+        return false;
+    }
+
+    bool IsPointToPoint() const override
+    {
+        return false;
+    }
+
+    bool Send(Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber) override
+    {
+        const uint32_t need = m_channel->SubchannelsFor(packet->GetSize());
+        if (need == 0 || m_queue.size() >= m_queueSize)
+        {
+            m_macTxDrop(packet);
+            return false;
+        }
+        m_queue.push_back({packet, Mac48Address::ConvertFrom(dest), protocolNumber});
+        if (!m_reserved)
+        {
+            Select(need);
+        }
+        return true;
+    }
+
+    bool SendFrom(Ptr<Packet>, const Address&, const Address&, uint16_t) override
+    {
+        return false;
+    }
+
+    Ptr<Node> GetNode() const override
+    {
+        return m_node;
+    }
+
+    void SetNode(Ptr<Node> node) override
+    {
+        m_node = node;
+    }
+
+    bool NeedsArp() const override
+    {
+        return true;
+    }
+
+    void SetReceiveCallback(NetDevice::ReceiveCallback cb) override
+    {
+        m_rxCallback = cb;
+    }
+
+    void SetPromiscReceiveCallback(NetDevice::PromiscReceiveCallback cb) override
+    {
+        m_promiscCallback = cb;
+    }
+
+    bool SupportsSendFrom() const override
+    {
+        return false;
+    }
+
+    // --- used by the channel
+    double GetTxPowerDbm() const
+    {
+        return m_txPowerDbm;
+    }
+
+    /// True if this device transmits in subframe `sf` (half duplex).
+    bool IsTransmitting(int64_t sf) const
+    {
+        return m_lastTxSubframe == sf;
+    }
+
+    /// A subframe's per-subchannel S-RSSI (mW, noise included) ended.
+    void Sense(int64_t sf, const double* subMw, double cbrThresholdMw)
+    {
+        EnsureSensingState();
+        const uint32_t nSub = m_channel->GetNSubchannels();
+        const uint32_t key = static_cast<uint32_t>(sf % RriMs());
+        AgeRssi(key, sf - RriMs());
+        const bool first = m_rssiSf[key] < 0;
+        uint32_t busy = 0;
+        for (uint32_t s = 0; s < nSub; ++s)
+        {
+            double& avg = m_rssiMw[key * nSub + s];
+            avg = first ? subMw[s] : 0.9 * avg + 0.1 * subMw[s];
+            busy += subMw[s] > cbrThresholdMw;
+        }
+        m_rssiSf[key] = sf;
+        if (busy > 0)
+        {
+            m_cbrHistory.push_back({sf, busy});
+            m_cbrBusy += busy;
+        }
+        TrimCbr(sf);
+    }
+
+    /// A neighbour's reservation was decoded with `rsrpDbm` per subchannel.
+    void NoteReservation(int64_t sf, uint32_t firstSub, uint32_t nSub, double rsrpDbm)
+    {
+        EnsureSensingState();
+        const uint32_t n = m_channel->GetNSubchannels();
+        const uint32_t key = static_cast<uint32_t>(sf % RriMs());
+        for (uint32_t s = firstSub; s < firstSub + nSub; ++s)
+        {
+            const uint32_t k = key * n + s;
+            // keep the strongest recent one; older entries expire after 1 s
+            if (m_sensedUntil[k] <= sf || rsrpDbm > m_sensedRsrp[k])
+            {
+                m_sensedRsrp[k] = static_cast<float>(rsrpDbm);
+            }
+            m_sensedUntil[k] = sf + SENSING_WINDOW_MS;
+        }
+    }
+
+    void Receive(Ptr<Packet> p, Mac48Address from, Mac48Address dst, uint16_t protocol)
+    {
+        m_phyRxOk(p);
+        NetDevice::PacketType type = NetDevice::PACKET_OTHERHOST;
+        if (dst.IsBroadcast())
+        {
+            type = NetDevice::PACKET_BROADCAST;
+        }
+        else if (dst.IsGroup())
+        {
+            type = NetDevice::PACKET_MULTICAST;
+        }
+        else if (dst == m_address)
+        {
+            type = NetDevice::PACKET_HOST;
+        }
+        if (!m_promiscCallback.IsNull())
+        {
+            m_promiscCallback(this, p, protocol, from, dst, type);
+        }
+        if (type != NetDevice::PACKET_OTHERHOST && !m_rxCallback.IsNull())
+        {
+            m_rxCallback(this, p, protocol, from);
+        }
+    }
+
+    void NotifyRxDrop(Ptr<const Packet> p)
+    {
+        m_phyRxDrop(p);
+    }
+
+    /// CBR over the last 100 subframes.
+    double GetChannelBusyRatio()
+    {
+        TrimCbr(Simulator::Now().GetMilliSeconds());
+        return double(m_cbrBusy) / (CBR_WINDOW_MS * m_channel->GetNSubchannels());
+    }
+
+    uint64_t GetReselections() const
+    {
+        return m_reselections;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_txEvent.Cancel();
+        m_queue.clear();
+        m_channel = nullptr;
+        m_node = nullptr;
+        m_rxCallback.Nullify();
+        m_promiscCallback.Nullify();
+        NetDevice::DoDispose();
+    }
+
+  private:
+    static constexpr int64_t SENSING_WINDOW_MS = 1000;
+    static constexpr int64_t CBR_WINDOW_MS = 100;
+
+    struct Queued
+    {
+        Ptr<Packet> p;
+        Mac48Address dst;
+        uint16_t protocol;
+    };
+
+    void TrimCbr(int64_t now)
+    {
+        while (!m_cbrHistory.empty() && m_cbrHistory.front().first <= now - CBR_WINDOW_MS)
+        {
+            m_cbrBusy -= m_cbrHistory.front().second;
+            m_cbrHistory.pop_front();
+        }
+    }
+
+    int64_t RriMs() const
+    {
+        return std::max<int64_t>(1, m_rri.GetMilliSeconds());
+    }
+
+    void EnsureSensingState()
+    {
+        const size_t cells = RriMs() * m_channel->GetNSubchannels();
+        if (m_rssiMw.size() != cells)
+        {
+            m_rssiMw.assign(cells, 0.0);
+            m_rssiSf.assign(RriMs(), -1);
+            m_sensedRsrp.assign(cells, 0.0f);
+            m_sensedUntil.assign(cells, 0);
+        }
+    }
+
+    /// Apply the noise-only updates of the occurrences of `key` after the
+    /// last sensed one, up to subframe `sf`; 0.9^k of the excess remains.
+    void AgeRssi(uint32_t key, int64_t sf)
+    {
+        const int64_t last = m_rssiSf[key];
+        if (last < 0 || sf <= last)
+        {
+            return;
+        }
+        const double keep = std::pow(0.9, double((sf - last) / RriMs()));
+        const double noiseMw = m_channel->GetNoiseMw();
+        const uint32_t nSub = m_channel->GetNSubchannels();
+        for (uint32_t s = 0; s < nSub; ++s)
+        {
+            double& avg = m_rssiMw[key * nSub + s];
+            avg = noiseMw + (avg - noiseMw) * keep;
+        }
+        m_rssiSf[key] = sf;
+    }
+
+    /// Pick a resource for `need` subchannels in the next RRI and arm it.
+    void Select(uint32_t need)
+    {
+        EnsureSensingState();
+        const int64_t now = Simulator::Now().GetMilliSeconds();
+        const int64_t rri = RriMs();
+        const uint32_t nSub = m_channel->GetNSubchannels();
+        const uint32_t starts = nSub - need + 1;
+        const size_t total = size_t(rri) * starts;
+
+        // candidate c = (subframe now + 1 + c / starts, first subchannel c % starts)
+        m_candidate.assign(total, 1);
+        double threshold = m_sensingThresholdDbm;
+        size_t remaining = 0;
+        for (int round = 0; round < 40; ++round, threshold += 3.0)
+        {
+            remaining = 0;
+            for (size_t c = 0; c < total; ++c)
+            {
+                const int64_t sf = now + 1 + int64_t(c / starts);
+                const uint32_t key = static_cast<uint32_t>(sf % rri);
+                const uint32_t first = static_cast<uint32_t>(c % starts);
+                bool free = true;
+                for (uint32_t s = first; s < first + need && free; ++s)
+                {
+                    const uint32_t k = key * nSub + s;
+                    free = m_sensedUntil[k] <= now || m_sensedRsrp[k] <= threshold;
+                }
+                m_candidate[c] = free;
+                remaining += free;
+            }
+            if (remaining * 5 >= total)
+            {
+                break;
+            }
+        }
+
+        // keep the 20% of all candidates with the lowest average S-RSSI
+        m_ranked.clear();
+        for (size_t c = 0; c < total; ++c)
+        {
+            if (!m_candidate[c])
+            {
+                continue;
+            }
+            const int64_t sf = now + 1 + int64_t(c / starts);
+            const uint32_t key = static_cast<uint32_t>(sf % rri);
+            const uint32_t first = static_cast<uint32_t>(c % starts);
+            AgeRssi(key, sf - rri);
+            double rssi = 0;
+            for (uint32_t s = first; s < first + need; ++s)
+            {
+                rssi += m_rssiMw[key * nSub + s];
+            }
+            m_ranked.push_back({rssi, static_cast<uint32_t>(c)});
+        }
+        NS_ASSERT_MSG(!m_ranked.empty(), "No sidelink candidate resource left");
+        const size_t keep = std::max<size_t>(1, std::min(m_ranked.size(), (total + 4) / 5));
+        std::nth_element(m_ranked.begin(), m_ranked.begin() + (keep - 1), m_ranked.end());
+        const uint32_t pick =
+            m_ranked[m_rng->GetInteger(0, static_cast<uint32_t>(keep - 1))].second;
+
+        m_reserved = true;
+        m_nextTx = now + 1 + pick / starts;
+        m_firstSub = pick % starts;
+        m_nSub = need;
+        m_counter = m_rng->GetInteger(5, 15);
+        m_unused = 0;
+        ++m_reselections;
+        ArmTx();
+    }
+
+    void ArmTx()
+    {
+        m_txEvent.Cancel();
+        m_txEvent = Simulator::Schedule(MilliSeconds(m_nextTx) - Simulator::Now(),
+                                        &V2xSidelinkNetDevice::TxOpportunity,
+                                        this);
+    }
+
+    void TxOpportunity()
+    {
+        if (m_queue.empty())
+        {
+            if (++m_unused >= m_reselectAfter)
+            {
+                m_reserved = false;
+                return;
+            }
+            m_nextTx += RriMs();
+            ArmTx();
+            return;
+        }
+        Queued q = m_queue.front();
+        const uint32_t need = m_channel->SubchannelsFor(q.p->GetSize());
+        if (need > m_nSub)
+        {
+            Select(need); // the reservation is too small for this packet
+            return;
+        }
+        m_queue.pop_front();
+        m_unused = 0;
+        m_lastTxSubframe = m_nextTx;
+        m_phyTx(q.p);
+        m_channel->Transmit(this, q.p, q.dst, q.protocol, m_firstSub, m_nSub);
+        if (--m_counter == 0 && m_rng->GetValue() >= m_probKeep)
+        {
+            Select(m_nSub);
+            return;
+        }
+        if (m_counter == 0)
+        {
+            m_counter = m_rng->GetInteger(5, 15);
+        }
+        m_nextTx += RriMs();
+        ArmTx();
+    }
+
+    Ptr<Node> m_node;
+    Ptr<V2xSidelinkChannel> m_channel;
+    Mac48Address m_address;
+    uint32_t m_ifIndex{0};
+    uint16_t m_mtu{1500};
+    NetDevice::ReceiveCallback m_rxCallback;
+    NetDevice::PromiscReceiveCallback m_promiscCallback;
+    Ptr<UniformRandomVariable> m_rng;
+
+    double m_txPowerDbm{23.0};
+    Time m_rri{MilliSeconds(100)};
+    double m_probKeep{0.8};
+    uint32_t m_reselectAfter{5};
+    double m_sensingThresholdDbm{-110.0};
+    uint32_t m_queueSize{10};
+
+    std::deque<Queued> m_queue;
+    bool m_reserved{false};
+    int64_t m_nextTx{0}; //!< next reserved subframe (ms)
+    uint32_t m_firstSub{0};
+    uint32_t m_nSub{1};
+    uint32_t m_counter{0};
+    uint32_t m_unused{0};
+    int64_t m_lastTxSubframe{-1};
+    EventId m_txEvent;
+    uint64_t m_reselections{0};
+
+    // sensing state, one cell per (subframe mod RRI, subchannel)
+    std::vector<double> m_rssiMw;
+    std::vector<int64_t> m_rssiSf; //!< last subframe folded into each key, -1 if none
+    std::vector<float> m_sensedRsrp;
+    std::vector<int64_t> m_sensedUntil;
+    std::vector<uint8_t> m_candidate;
+    std::vector<std::pair<double, uint32_t>> m_ranked;
+    std::deque<std::pair<int64_t, uint32_t>> m_cbrHistory; //!< (subframe, busy subchannels)
+    uint64_t m_cbrBusy{0};
+
+    TracedCallback<Ptr<const Packet>> m_phyTx;
+    TracedCallback<Ptr<const Packet>> m_phyRxOk;
+    TracedCallback<Ptr<const Packet>> m_phyRxDrop;
+    TracedCallback<Ptr<const Packet>> m_macTxDrop;
+};
+
+inline void
+V2xSidelinkChannel::Add(Ptr<V2xSidelinkNetDevice> dev)
+{
+    m_devices.push_back(dev);
+}
+
+inline Ptr<NetDevice>
+V2xSidelinkChannel::GetDevice(std::size_t i) const
+{
+    return m_devices[i];
+}
+
+inline void
+V2xSidelinkChannel::Transmit(Ptr<V2xSidelinkNetDevice> dev,
+                             Ptr<Packet> p,
+                             Mac48Address dst,
+                             uint16_t protocol,
+                             uint32_t firstSub,
+                             uint32_t nSub)
+{
+    const int64_t sf = Simulator::Now().GetMilliSeconds();
+    std::vector<Tx>& batch = m_pending[sf];
+    if (batch.empty())
+    {
+        Simulator::Schedule(MilliSeconds(sf + 1) - Simulator::Now(),
+                            &V2xSidelinkChannel::Resolve,
+                            this,
+                            sf);
+    }
+    batch.push_back({dev, p, dst, protocol, firstSub, nSub});
+    ++m_stats.transmissions;
+}
+
+inline void
+V2xSidelinkChannel::DoDispose()
+{
+    m_devices.clear();
+    m_pending.clear();
+    m_loss = nullptr;
+    m_store = nullptr;
+    m_distanceLoss = nullptr;
+    Channel::DoDispose();
+}
+
+inline void
+V2xSidelinkChannel::Resolve(int64_t sf)
+{
+    std::vector<Tx> txs;
+    auto it = m_pending.find(sf);
+    if (it == m_pending.end())
+    {
+        return;
+    }
+    txs.swap(it->second);
+    m_pending.erase(it);
+    const int64_t now = Simulator::Now().GetTimeStep();
+    const double noiseMw = std::pow(10.0, m_noiseDbm / 10.0);
+    const double cbrMw = std::pow(10.0, m_cbrThresholdDbm / 10.0);
+    const double sinrMin = std::pow(10.0, m_sinrThresholdDb / 10.0);
+    const double sensMw = std::pow(10.0, m_sensitivityDbm / 10.0);
+    const size_t n = txs.size();
+
+    m_txPos.resize(n);
+    m_txSlot.resize(n);
+    m_txMobility.resize(n);
+    for (size_t j = 0; j < n; ++j)
+    {
+        Ptr<Node> node = txs[j].dev->GetNode();
+        m_txMobility[j] = node->GetObject<MobilityModel>();
+        m_txSlot[j] = m_store ? m_store->SlotOf(node->GetId()) : V2xPositionStore::NONE;
+        m_txPos[j] = m_txSlot[j] != V2xPositionStore::NONE ? m_store->Get(m_txSlot[j], now)
+                                                           : m_txMobility[j]->GetPosition();
+    }
+
+    m_rxMw.resize(n);
+    m_subMw.resize(m_nSub);
+    for (const Ptr<V2xSidelinkNetDevice>& rx : m_devices)
+    {
+        Ptr<Node> rxNode = rx->GetNode();
+        const uint32_t rxSlot = m_store ? m_store->SlotOf(rxNode->GetId()) : V2xPositionStore::NONE;
+        Ptr<MobilityModel> rxMobility;
+        Vector rxPos;
+        if (rxSlot != V2xPositionStore::NONE)
+        {
+            rxPos = m_store->Get(rxSlot, now);
+        }
+        else
+        {
+            rxMobility = rxNode->GetObject<MobilityModel>();
+            rxPos = rxMobility->GetPosition();
+        }
+        const bool transmitting = rx->IsTransmitting(sf);
+        std::fill(m_subMw.begin(), m_subMw.end(), noiseMw);
+        size_t audible = 0;
+        for (size_t j = 0; j < n; ++j)
+        {
+            m_rxMw[j] = 0;
+            if (txs[j].dev == rx)
+            {
+                continue;
+            }
+            const double dx = rxPos.x - m_txPos[j].x;
+            const double dy = rxPos.y - m_txPos[j].y;
+            const double dz = rxPos.z - m_txPos[j].z;
+            const double d2 = dx * dx + dy * dy + dz * dz;
+            if (m_maxRange > 0 && d2 > m_maxRange * m_maxRange)
+            {
+                continue;
+            }
+            double rxDbm;
+            if (m_distanceLoss && rxSlot != V2xPositionStore::NONE &&
+                m_txSlot[j] != V2xPositionStore::NONE)
+            {
+                rxDbm = txs[j].dev->GetTxPowerDbm() - m_distanceLoss(d2);
+            }
+            else
+            {
+                if (!rxMobility)
+                {
+                    rxMobility = rxNode->GetObject<MobilityModel>();
+                }
+                rxDbm = m_loss ? m_loss->CalcRxPower(txs[j].dev->GetTxPowerDbm(),
+                                                     m_txMobility[j],
+                                                     rxMobility)
+                               : txs[j].dev->GetTxPowerDbm();
+            }
+            // power is spread evenly over the transmission's subchannels
+            const double perSub = std::pow(10.0, rxDbm / 10.0) / txs[j].nSub;
+            m_rxMw[j] = perSub;
+            for (uint32_t s = txs[j].firstSub; s < txs[j].firstSub + txs[j].nSub; ++s)
+            {
+                m_subMw[s] += perSub;
+            }
+            ++audible;
+        }
+        if (audible == 0)
+        {
+            continue;
+        }
+        if (transmitting)
+        {
+            // half duplex: neither decodes nor senses this subframe
+            for (size_t j = 0; j < n; ++j)
+            {
+                m_stats.halfDuplex += m_rxMw[j] * txs[j].nSub >= sensMw;
+            }
+            continue;
+        }
+        rx->Sense(sf, m_subMw.data(), cbrMw);
+        for (size_t j = 0; j < n; ++j)
+        {
+            const Tx& t = txs[j];
+            if (m_rxMw[j] * t.nSub < sensMw)
+            {
+                continue;
+            }
+            double interference = 0;
+            for (uint32_t s = t.firstSub; s < t.firstSub + t.nSub; ++s)
+            {
+                interference += m_subMw[s] - m_rxMw[j];
+            }
+            const double sinr = m_rxMw[j] * t.nSub / interference;
+            if (sinr < sinrMin)
+            {
+                ++m_stats.sinrFailures;
+                rx->NotifyRxDrop(t.p);
+                continue;
+            }
+            ++m_stats.received;
+            rx->NoteReservation(sf, t.firstSub, t.nSub, 10.0 * std::log10(m_rxMw[j]));
+            Simulator::ScheduleWithContext(rxNode->GetId(),
+                                           Seconds(0),
+                                           &V2xSidelinkNetDevice::Receive,
+                                           rx,
+                                           t.p->Copy(),
+                                           Mac48Address::ConvertFrom(t.dev->GetAddress()),
+                                           t.dst,
+                                           t.protocol);
+        }
+    }
+}
+
+NS_OBJECT_ENSURE_REGISTERED(V2xSidelinkChannel);
+NS_OBJECT_ENSURE_REGISTERED(V2xSidelinkNetDevice);
+
+} // namespace ns3
+
+#endif /* V2X_SIDELINK_H */
@@ -0,0 +1,223 @@
+/* v2x-snapshot.h
+ *
+ * Post-setup scenario snapshot (--snapshotSave / --snapshotLoad).
+ * - Saved once the stack is up: local vehicle indices (the MPI
+ *   partition), vehicle and RSU positions, the initial RSU association and
+ *   the MAC and IPv4 address of every radio device
+ * - Loaded in place of topology generation, strip partitioning, RSU
+ *   placement and the initial nearest-RSU search; the saved MACs are
+ *   written back onto the devices before addressing, and the IPv4
+ *   assignment is checked against the snapshot, so ARP tables, neighbor
+ *   tables and the association come out identical in every run
+ * - A fingerprint of every setup-relevant option guards against loading a
+ *   snapshot into a different scenario; traffic, metrics and tracing
+ *   options are free to change between save and load
+ *
+ * ns-3 objects (nodes, devices, stacks) cannot be serialized, so they are
+ * still created per run; the snapshot removes the setup work computed
+ * from the configuration and pins its results.
+ *
+ * Layout (host byte order): magic "V2XSNP01", uint32 version = 1,
+ * uint64 fingerprint, then uint32-counted arrays: globalIndex[uint32],
+ * vehiclePositions[3 x double], rsuPositions[3 x double],
+ * association[uint32], macs[uint64, low 48 bits], ipv4[uint32].
+ */
+
+#ifndef V2X_SNAPSHOT_H
+#define V2X_SNAPSHOT_H
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/mac48-address.h"
+#include "ns3/vector.h"
+
+#include "v2x-scenario.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+struct V2xSnapshot
+{
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t fingerprint{0};
+    std::vector<uint32_t> globalIndex;
+    std::vector<Vector> vehiclePositions;
+    std::vector<Vector> rsuPositions;
+    std::vector<uint32_t> association;
+    std::vector<uint64_t> macs; //!< every radio device, access layer order
+    std::vector<uint32_t> ipv4; //!< same order
+
+    /// FNV-1a over the options that shape the set-up scenario.
+    static uint64_t Fingerprint(const ScenarioConfig& cfg, uint32_t nSystems, uint32_t systemId)
+    {
+        std::ostringstream os;
+        os.precision(17);
+        const V2xTopologyParams& t = cfg.topo;
+        os << cfg.nVehicles << '|' << cfg.nRsus << '|' << t.layout << '|' << t.spacing << '|'
+           << t.gridColumns << '|' << t.nLanes << '|' << t.laneWidth << '|' << t.nStreets << '|'
+           << t.blockSize << '|' << cfg.mobilityTrace << '|' << cfg.accessLayer << '|'
+           << cfg.wifiMode << '|' << cfg.nServiceChannels << '|' << cfg.channelModel << '|'
+           << nSystems << '|' << systemId;
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (char c : os.str())
+        {
+            h = (h ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    static uint64_t MacToInt(const Mac48Address& mac)
+    {
+        uint8_t b[6];
+        mac.CopyTo(b);
+        uint64_t v = 0;
+        for (uint8_t x : b)
+        {
+            v = (v << 8) | x;
+        }
+        return v;
+    }
+
+    static Mac48Address IntToMac(uint64_t v)
+    {
+        uint8_t b[6];
+        for (int i = 5; i >= 0; --i)
+        {
+            b[i] = static_cast<uint8_t>(v & 0xff);
+            v >>= 8;
+        }
+        Mac48Address mac;
+        mac.CopyFrom(b);
+        return mac;
+    }
+
+    void Save(const std::string& fileName) const
+    {
+        std::ofstream os(fileName, std::ios::out | std::ios::binary);
+        NS_ABORT_MSG_IF(!os.is_open(), "Cannot open snapshot " << fileName);
+        os.write("V2XSNP01", 8);
+        WritePod(os, VERSION);
+        WritePod(os, fingerprint);
+        WriteArray(os, globalIndex);
+        WriteVectors(os, vehiclePositions);
+        WriteVectors(os, rsuPositions);
+        WriteArray(os, association);
+        WriteArray(os, macs);
+        WriteArray(os, ipv4);
+        NS_ABORT_MSG_IF(!os, "Error writing snapshot " << fileName);
+    }
+
+    void Load(const std::string& fileName)
+    {
+        std::ifstream is(fileName, std::ios::in | std::ios::binary);
+        NS_ABORT_MSG_IF(!is.is_open(), "Cannot open snapshot " << fileName);
+        char magic[8];
+        is.read(magic, 8);
+        NS_ABORT_MSG_IF(!is || std::memcmp(magic, "V2XSNP01", 8) != 0,
+                        fileName << " is not a V2X snapshot");
+        uint32_t version = 0;
+        ReadPod(is, version);
+        NS_ABORT_MSG_IF(version != VERSION, "Unsupported snapshot version " << version);
+        ReadPod(is, fingerprint);
+        ReadArray(is, globalIndex);
+        ReadVectors(is, vehiclePositions);
+        ReadVectors(is, rsuPositions);
+        ReadArray(is, association);
+        ReadArray(is, macs);
+        ReadArray(is, ipv4);
+        NS_ABORT_MSG_IF(!is, "Truncated snapshot " << fileName);
+        NS_ABORT_MSG_IF(vehiclePositions.size() != globalIndex.size() ||
+                            association.size() != globalIndex.size() || macs.size() != ipv4.size(),
+                        "Inconsistent snapshot " << fileName << ": " << globalIndex.size()
+                                                 << " vehicles, " << vehiclePositions.size()
+                                                 << " positions, " << association.size()
+                                                 << " associations, " << macs.size() << " MACs, "
+                                                 << ipv4.size() << " addresses");
+        for (uint32_t r : association)
+        {
+            NS_ABORT_MSG_IF(r >= rsuPositions.size(),
+                            "Inconsistent snapshot " << fileName << ": association to RSU " << r
+                                                     << " of " << rsuPositions.size());
+        }
+    }
+
+  private:
+    template <typename T>
+    static void WritePod(std::ostream& os, const T& v)
+    {
+        os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    template <typename T>
+    static void ReadPod(std::istream& is, T& v)
+    {
+        is.read(reinterpret_cast<char*>(&v), sizeof(T));
+    }
+
+    template <typename T>
+    static void WriteArray(std::ostream& os, const std::vector<T>& v)
+    {
+        WritePod(os, static_cast<uint32_t>(v.size()));
+        os.write(reinterpret_cast<const char*>(v.data()),
+                 static_cast<std::streamsize>(v.size() * sizeof(T)));
+    }
+
+    template <typename T>
+    static void ReadArray(std::istream& is, std::vector<T>& v)
+    {
+        uint32_t n = 0;
+        ReadPod(is, n);
+        if (!is)
+        {
+            v.clear();
+            return; // Load() reports the truncation
+        }
+        // the count is untrusted: never allocate more than the file still holds
+        const std::streampos pos = is.tellg();
+        is.seekg(0, std::ios::end);
+        const std::streamoff left = is.tellg() - pos;
+        is.seekg(pos);
+        NS_ABORT_MSG_IF(static_cast<uint64_t>(n) * sizeof(T) > static_cast<uint64_t>(left),
+                        "Corrupt snapshot: array of " << n << " x " << sizeof(T) << " bytes, "
+                                                      << left << " bytes left");
+        v.resize(n);
+        is.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+    }
+
+    static void WriteVectors(std::ostream& os, const std::vector<Vector>& v)
+    {
+        std::vector<double> flat;
+        flat.reserve(3 * v.size());
+        for (const Vector& p : v)
+        {
+            flat.push_back(p.x);
+            flat.push_back(p.y);
+            flat.push_back(p.z);
+        }
+        WriteArray(os, flat);
+    }
+
+    static void ReadVectors(std::istream& is, std::vector<Vector>& v)
+    {
+        std::vector<double> flat;
+        ReadArray(is, flat);
+        v.clear();
+        v.reserve(flat.size() / 3);
+        for (size_t i = 0; i + 2 < flat.size(); i += 3)
+        {
+            v.emplace_back(flat[i], flat[i + 1], flat[i + 2]);
+        }
+    }
+};
+
+} // namespace ns3
+
+#endif /* V2X_SNAPSHOT_H */
@@ -0,0 +1,221 @@
+/* v2x-sweep.h
+ *
+ * Parameter sweep over nVehicles x simTime x RNG run.
+ * - Each run is a forked child calling RunScenario(); at most `jobs`
+ *   children are alive at once
+ * - A child's stdout goes to <outputPrefix>.log and its ScenarioResult
+ *   comes back through a pipe
+ * - The parent writes one merged CSV at the end; runs keep their cheap
+ *   columnar results file but never the FlowMonitor XML
+ * - Per-run files are named after the run's outputPrefix (NetAnim too);
+ *   snapshots are dropped, as in the benchmark matrix, since concurrent
+ *   runs would share one file and a varying setup fails the fingerprint
+ * - Execute() is the bare process pool, shared with the benchmark matrix
+ */
+
+#ifndef V2X_SWEEP_H
+#define V2X_SWEEP_H
+
+#include "ns3/abort.h"
+
+#include "v2x-scenario.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+struct V2xSweepSpec
+{
+    std::string vehicles;  //!< comma list, empty = the base nVehicles
+    std::string simTimes;  //!< comma list, empty = the base simTime
+    std::string runs;      //!< comma list of RNG runs, empty = the base rngRun
+    uint32_t jobs = 0;     //!< concurrent processes, 0 = hardware threads
+    std::string output = "v2x-sweep-results.csv";
+};
+
+class V2xSweepRunner
+{
+  public:
+    template <typename T>
+    static std::vector<T> ParseList(const std::string& list, T fallback)
+    {
+        std::vector<T> values;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            if (item.empty())
+            {
+                continue;
+            }
+            std::stringstream is(item);
+            T v;
+            is >> v;
+            NS_ABORT_MSG_IF(is.fail(), "Bad sweep value '" << item << "'");
+            values.push_back(v);
+        }
+        if (values.empty())
+        {
+            values.push_back(fallback);
+        }
+        return values;
+    }
+
+    /// Cartesian product of the spec's lists on top of `base`.
+    static std::vector<ScenarioConfig> Expand(const ScenarioConfig& base, const V2xSweepSpec& spec)
+    {
+        std::vector<ScenarioConfig> configs;
+        for (uint32_t n : ParseList<uint32_t>(spec.vehicles, base.nVehicles))
+        {
+            for (double t : ParseList<double>(spec.simTimes, base.simTime))
+            {
+                for (uint32_t run : ParseList<uint32_t>(spec.runs, base.rngRun))
+                {
+                    ScenarioConfig cfg = base;
+                    cfg.nVehicles = n;
+                    cfg.simTime = t;
+                    cfg.rngRun = run;
+                    if (cfg.resultsFormat != "none")
+                    {
+                        cfg.resultsFormat = "columnar";
+                    }
+                    cfg.logFile.clear();
+                    cfg.snapshotSave.clear();
+                    cfg.snapshotLoad.clear();
+                    cfg.outputPrefix =
+                        base.outputPrefix + "-sweep-" + std::to_string(configs.size());
+                    cfg.netAnimFile = cfg.outputPrefix + "-netanim.xml";
+                    configs.push_back(cfg);
+                }
+            }
+        }
+        return configs;
+    }
+
+    /// Run every config in `jobs` processes; ok[i] tells whether results[i] is valid.
+    static void Execute(const std::vector<ScenarioConfig>& configs,
+                        uint32_t jobs,
+                        std::vector<ScenarioResult>& results,
+                        std::vector<bool>& ok)
+    {
+        if (jobs == 0)
+        {
+            jobs = std::max(1u, std::thread::hardware_concurrency());
+        }
+        struct Child
+        {
+            size_t job;
+            int fd;
+        };
+
+        results.assign(configs.size(), ScenarioResult{});
+        ok.assign(configs.size(), false);
+        std::map<pid_t, Child> running;
+        size_t next = 0;
+        std::cout << "Sweep: " << configs.size() << " runs, " << jobs << " concurrent\n";
+
+        while (next < configs.size() || !running.empty())
+        {
+            while (next < configs.size() && running.size() < jobs)
+            {
+                int fds[2];
+                NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+                std::cout.flush();
+                pid_t pid = fork();
+                NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+                if (pid == 0)
+                {
+                    close(fds[0]);
+                    const ScenarioConfig& cfg = configs[next];
+                    if (!freopen((cfg.outputPrefix + ".log").c_str(), "w", stdout))
+                    {
+                        _exit(2);
+                    }
+                    ScenarioResult r = RunScenario(cfg);
+                    std::cout.flush();
+                    ssize_t n = write(fds[1], &r, sizeof(r));
+                    close(fds[1]);
+                    _exit(n == static_cast<ssize_t>(sizeof(r)) ? 0 : 1);
+                }
+                close(fds[1]);
+                running[pid] = {next, fds[0]};
+                ++next;
+            }
+
+            int status = 0;
+            pid_t pid = waitpid(-1, &status, 0);
+            if (pid < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            auto it = running.find(pid);
+            if (it == running.end())
+            {
+                continue;
+            }
+            const Child child = it->second;
+            running.erase(it);
+            ScenarioResult r;
+            ssize_t n = read(child.fd, &r, sizeof(r));
+            close(child.fd);
+            if (n == static_cast<ssize_t>(sizeof(r)) && WIFEXITED(status) &&
+                WEXITSTATUS(status) == 0)
+            {
+                results[child.job] = r;
+                ok[child.job] = true;
+            }
+            std::cout << "Sweep: run " << child.job << " "
+                      << (ok[child.job] ? "done" : "FAILED") << " (" << (next - running.size())
+                      << "/" << configs.size() << ")\n";
+        }
+    }
+
+    /// Run every config; returns the number of failed runs.
+    static uint32_t Run(const std::vector<ScenarioConfig>& configs,
+                        uint32_t jobs,
+                        const std::string& output)
+    {
+        std::vector<ScenarioResult> results;
+        std::vector<bool> ok;
+        Execute(configs, jobs, results, ok);
+
+        std::ofstream os(output);
+        NS_ABORT_MSG_IF(!os.is_open(), "Cannot open sweep output " << output);
+        os << "run,nVehicles,simTime,rngRun,txPackets,rxPackets,pdr,meanDelayMs,latencyP50Ms,"
+              "latencyP95Ms,latencyP99Ms,meanAoiMs,events,wallSeconds,peakRssKb,status\n";
+        uint32_t failed = 0;
+        for (size_t i = 0; i < configs.size(); ++i)
+        {
+            const ScenarioResult& r = results[i];
+            os << i << ',' << configs[i].nVehicles << ',' << configs[i].simTime << ','
+               << configs[i].rngRun << ',' << r.txPackets << ',' << r.rxPackets << ','
+               << r.GetPdr() << ',' << r.meanDelayMs << ',' << r.latencyP50Ms << ','
+               << r.latencyP95Ms << ',' << r.latencyP99Ms << ',' << r.meanAoiMs << ','
+               << r.events << ',' << r.wallSeconds << ',' << r.peakRssKb
+               << ',' << (ok[i] ? "ok" : "failed") << '\n';
+            failed += ok[i] ? 0 : 1;
+        }
+        std::cout << "Sweep: results in " << output << " (" << failed << " failed)\n";
+        return failed;
+    }
+};
+
+} // namespace ns3
+
+#endif /* V2X_SWEEP_H */
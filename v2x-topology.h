@@ -0,0 +1,246 @@
+/* v2x-topology.h
+ *
+ * Bulk vehicle/RSU placement for the V2X scenario.
+ * - line:      legacy single row (5 + spacing * i, 0)
+ * - grid:      rows x columns, `spacing` apart
+ * - highway:   nLanes parallel lanes along x, odd lanes staggered
+ * - manhattan: nStreets x nStreets street grid, vehicles spread over all
+ *              streets round-robin; x streets are driven laneWidth/2 on
+ *              one side of the street line and y streets on the other, so
+ *              crossing streets never share an intersection slot
+ *
+ * RSUs: one at the legacy spot (line) or the bounding-box centre, or n
+ * spread evenly along the longer side of the vehicle bounding box.
+ *
+ * Positions are generated into one vector and mobility models are created
+ * and aggregated directly, so large scenarios skip the per-node
+ * ObjectFactory/attribute work done by MobilityHelper + PositionAllocator.
+ */
+
+#ifndef V2X_TOPOLOGY_H
+#define V2X_TOPOLOGY_H
+
+#include "ns3/abort.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+struct V2xTopologyParams
+{
+    std::string layout = "line"; //!< line | grid | highway | manhattan
+    double spacing = 20.0;       //!< distance between neighbouring vehicles (m)
+    uint32_t gridColumns = 0;    //!< grid: columns, 0 = ceil(sqrt(n))
+    uint32_t nLanes = 3;         //!< highway: number of lanes
+    double laneWidth = 3.5;      //!< highway / manhattan: lane width (m)
+    uint32_t nStreets = 4;       //!< manhattan: streets per direction
+    double blockSize = 100.0;    //!< manhattan: street spacing (m)
+};
+
+class V2xTopologyBuilder
+{
+  public:
+    static std::vector<Vector> Line(uint32_t n, double spacing)
+    {
+        std::vector<Vector> pos;
+        pos.reserve(n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            pos.emplace_back(5.0 + spacing * i, 0.0, 0.0);
+        }
+        return pos;
+    }
+
+    static std::vector<Vector> Grid(uint32_t n, uint32_t columns, double spacing)
+    {
+        if (columns == 0)
+        {
+            columns = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(double(n)))));
+        }
+        std::vector<Vector> pos;
+        pos.reserve(n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            pos.emplace_back(spacing * (i % columns), spacing * (i / columns), 0.0);
+        }
+        return pos;
+    }
+
+    static std::vector<Vector> Highway(uint32_t n, uint32_t nLanes, double laneWidth, double spacing)
+    {
+        NS_ABORT_MSG_IF(nLanes == 0, "Highway layout needs at least one lane");
+        std::vector<Vector> pos;
+        pos.reserve(n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            uint32_t lane = i % nLanes;
+            double stagger = (lane % 2) ? 0.5 * spacing : 0.0;
+            pos.emplace_back(spacing * (i / nLanes) + stagger, laneWidth * lane, 0.0);
+        }
+        return pos;
+    }
+
+    static std::vector<Vector> Manhattan(uint32_t n,
+                                         uint32_t nStreets,
+                                         double blockSize,
+                                         double laneWidth,
+                                         double spacing)
+    {
+        NS_ABORT_MSG_IF(nStreets < 2, "Manhattan layout needs at least two streets per direction");
+        NS_ABORT_MSG_IF(spacing <= 0, "Manhattan layout needs a positive --spacing");
+        NS_ABORT_MSG_IF(laneWidth <= 0, "Manhattan layout needs a positive --laneWidth");
+        const double length = blockSize * (nStreets - 1);
+        const uint32_t slots = std::max(1u, static_cast<uint32_t>(length / spacing) + 1);
+        const uint32_t nRoads = 2 * nStreets;
+        std::vector<Vector> pos;
+        pos.reserve(n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            uint32_t road = i % nRoads;
+            uint32_t k = i / nRoads;
+            // once every slot on a street is taken, start a parallel lane
+            double along = spacing * (k % slots);
+            double lane = laneWidth * (0.5 + k / slots);
+            double street = blockSize * (road / 2);
+            if (road % 2 == 0)
+            {
+                pos.emplace_back(along, street + lane, 0.0);
+            }
+            else
+            {
+                pos.emplace_back(street - lane, along, 0.0);
+            }
+        }
+        return pos;
+    }
+
+    static std::vector<Vector> Build(const V2xTopologyParams& p, uint32_t n)
+    {
+        if (p.layout == "line")
+        {
+            return Line(n, p.spacing);
+        }
+        if (p.layout == "grid")
+        {
+            return Grid(n, p.gridColumns, p.spacing);
+        }
+        if (p.layout == "highway")
+        {
+            return Highway(n, p.nLanes, p.laneWidth, p.spacing);
+        }
+        if (p.layout == "manhattan")
+        {
+            return Manhattan(n, p.nStreets, p.blockSize, p.laneWidth, p.spacing);
+        }
+        NS_ABORT_MSG("Unknown topology '" << p.layout << "' (line|grid|highway|manhattan)");
+        return {};
+    }
+
+    /// Centre of the bounding box of `positions` (z = 0).
+    static Vector BoundingBoxCentre(const std::vector<Vector>& positions)
+    {
+        if (positions.empty())
+        {
+            return Vector(0.0, 0.0, 0.0);
+        }
+        double minX = positions[0].x;
+        double maxX = minX;
+        double minY = positions[0].y;
+        double maxY = minY;
+        for (const Vector& v : positions)
+        {
+            minX = std::min(minX, v.x);
+            maxX = std::max(maxX, v.x);
+            minY = std::min(minY, v.y);
+            maxY = std::max(maxY, v.y);
+        }
+        return Vector(0.5 * (minX + maxX), 0.5 * (minY + maxY), 0.0);
+    }
+
+    /// RSU position for a layout: legacy spot for the line, otherwise the
+    /// centre of the vehicle bounding box (road side for the highway).
+    static Vector RsuPosition(const V2xTopologyParams& p, const std::vector<Vector>& vehicles)
+    {
+        if (p.layout == "line" || vehicles.empty())
+        {
+            return Vector(25.0, 50.0, 0.0);
+        }
+        Vector c = BoundingBoxCentre(vehicles);
+        if (p.layout == "highway")
+        {
+            double minY = vehicles[0].y;
+            for (const Vector& v : vehicles)
+            {
+                minY = std::min(minY, v.y);
+            }
+            c.y = minY - 10.0;
+        }
+        return c;
+    }
+
+    /// `n` RSU positions: RsuPosition() for one, otherwise the centres of n
+    /// equal segments along the longer side of the vehicle bounding box
+    /// (on the road side for the highway).
+    static std::vector<Vector> RsuPositions(const V2xTopologyParams& p,
+                                            const std::vector<Vector>& vehicles,
+                                            uint32_t n)
+    {
+        NS_ABORT_MSG_IF(n == 0, "Need at least one RSU");
+        if (n == 1 || vehicles.empty())
+        {
+            return std::vector<Vector>(n, RsuPosition(p, vehicles));
+        }
+        double minX = vehicles[0].x;
+        double maxX = minX;
+        double minY = vehicles[0].y;
+        double maxY = minY;
+        for (const Vector& v : vehicles)
+        {
+            minX = std::min(minX, v.x);
+            maxX = std::max(maxX, v.x);
+            minY = std::min(minY, v.y);
+            maxY = std::max(maxY, v.y);
+        }
+        const bool alongX = (maxX - minX) >= (maxY - minY);
+        const double cx = 0.5 * (minX + maxX);
+        const double cy = p.layout == "highway" ? minY - 10.0 : 0.5 * (minY + maxY);
+        std::vector<Vector> pos;
+        pos.reserve(n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            double f = (i + 0.5) / n;
+            if (alongX)
+            {
+                pos.emplace_back(minX + f * (maxX - minX), cy, 0.0);
+            }
+            else
+            {
+                pos.emplace_back(cx, minY + f * (maxY - minY), 0.0);
+            }
+        }
+        return pos;
+    }
+
+    /// Aggregate a ConstantPositionMobilityModel at positions[i] on node i.
+    static void Install(const NodeContainer& nodes, const std::vector<Vector>& positions)
+    {
+        NS_ABORT_MSG_IF(positions.size() < nodes.GetN(), "Fewer positions than nodes");
+        for (uint32_t i = 0; i < nodes.GetN(); ++i)
+        {
+            Ptr<ConstantPositionMobilityModel> m = CreateObject<ConstantPositionMobilityModel>();
+            m->SetPosition(positions[i]);
+            nodes.Get(i)->AggregateObject(m);
+        }
+    }
+};
+
+} // namespace ns3
+
+#endif /* V2X_TOPOLOGY_H */
@@ -0,0 +1,416 @@
+/* v2x-trace-mobility.h
+ *
+ * Streaming vehicle mobility from SUMO FCD or ns-2 mobility traces.
+ * - The trace is read in time windows: at time t the parser has consumed
+ *   everything up to t + 2 * window and the next read is scheduled at
+ *   t + window, so memory holds at most two windows of waypoints no matter
+ *   how long the trace is
+ * - Every vehicle runs a WaypointMobilityModel fed incrementally; the model
+ *   itself schedules only its next waypoint
+ * - Vehicles not yet in the trace are parked 1 km apart far from the
+ *   scenario and jump into place when they first appear
+ *
+ * FCD: <timestep time="t"> blocks of <vehicle id=".." x=".." y=".."/>, one
+ * element per line (SUMO's default); ids map to vehicles in order of first
+ * appearance. ns-2: `$node_(i) set X_/Y_` initial positions and
+ * `$ns_ at t "$node_(i) setdest x y speed"`; node i is vehicle i. Both must
+ * be sorted by time.
+ *
+ * ns-2 legs are held back until they are known: a setdest issued while the
+ * node is still moving takes over at once from the point reached at that
+ * time (the pending leg is cut there), and a leg still running at the end
+ * of a read gets a waypoint at that point, so the model never runs ahead
+ * of what the trace has said.
+ */
+
+#ifndef V2X_TRACE_MOBILITY_H
+#define V2X_TRACE_MOBILITY_H
+
+#include "ns3/abort.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/vector.h"
+#include "ns3/waypoint-mobility-model.h"
+#include "ns3/waypoint.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xTraceMobility : public SimpleRefCount<V2xTraceMobility>
+{
+  public:
+    static constexpr double PARK_OFFSET = -1.0e6; //!< parked vehicles: x = PARK_OFFSET
+
+    /// "fcd", "ns2", or "" to pick by extension (.xml = fcd).
+    void Open(const std::string& fileName, const std::string& format, Time window)
+    {
+        m_format = format;
+        if (m_format.empty())
+        {
+            bool xml = fileName.size() >= 4 && fileName.compare(fileName.size() - 4, 4, ".xml") == 0;
+            m_format = xml ? "fcd" : "ns2";
+        }
+        NS_ABORT_MSG_IF(m_format != "fcd" && m_format != "ns2",
+                        "Unknown mobility trace format '" << m_format << "' (fcd|ns2)");
+        NS_ABORT_MSG_IF(!window.IsStrictlyPositive(), "Mobility trace window must be positive");
+        m_window = window;
+        m_is.open(fileName);
+        NS_ABORT_MSG_IF(!m_is.is_open(), "Cannot open mobility trace " << fileName);
+    }
+
+    /**
+     * Aggregate a WaypointMobilityModel on every vehicle, park them and read
+     * the first two windows; later windows are read from scheduled events.
+     */
+    void Install(const NodeContainer& vehicles)
+    {
+        m_models.resize(vehicles.GetN());
+        m_state.assign(vehicles.GetN(), {});
+        for (uint32_t i = 0; i < vehicles.GetN(); ++i)
+        {
+            Ptr<WaypointMobilityModel> m = CreateObject<WaypointMobilityModel>();
+            m->SetPosition(ParkedPosition(i));
+            vehicles.Get(i)->AggregateObject(m);
+            m_models[i] = m;
+        }
+        ReadUntil(2 * m_window);
+        Simulator::Schedule(m_window, &V2xTraceMobility::ReadNext, this);
+    }
+
+    /// Initial trace position of each vehicle, parked position if unseen yet.
+    std::vector<Vector> GetInitialPositions() const
+    {
+        std::vector<Vector> pos(m_state.size());
+        for (uint32_t i = 0; i < m_state.size(); ++i)
+        {
+            pos[i] = m_state[i].seen ? m_state[i].first : ParkedPosition(i);
+        }
+        return pos;
+    }
+
+    /// Initial positions of the vehicles that appear in the first windows.
+    std::vector<Vector> GetSeenPositions() const
+    {
+        std::vector<Vector> pos;
+        for (const State& s : m_state)
+        {
+            if (s.seen)
+            {
+                pos.push_back(s.first);
+            }
+        }
+        return pos;
+    }
+
+    uint64_t GetWaypoints() const
+    {
+        return m_waypoints;
+    }
+
+    /// Trace entries for vehicles beyond the node count, or out of order.
+    uint64_t GetSkipped() const
+    {
+        return m_skipped;
+    }
+
+  private:
+    struct State
+    {
+        bool seen{false};
+        bool moving{false}; //!< has had a waypoint added
+        Vector first;
+        Vector last;   //!< last waypoint added
+        Time lastTime;
+        bool leg{false}; //!< ns-2: moving from `last` to legTo, not yet added
+        Vector legTo;
+        Time legArrive;
+    };
+
+    static Vector ParkedPosition(uint32_t i)
+    {
+        return Vector(PARK_OFFSET, 1000.0 * i, 0.0);
+    }
+
+    void ReadNext()
+    {
+        ReadUntil(Simulator::Now() + 2 * m_window);
+        if (!m_eof)
+        {
+            Simulator::Schedule(m_window, &V2xTraceMobility::ReadNext, this);
+        }
+    }
+
+    void ReadUntil(Time end)
+    {
+        std::string line;
+        while (!m_eof)
+        {
+            if (m_pending.empty())
+            {
+                if (!std::getline(m_is, line))
+                {
+                    m_eof = true;
+                    break;
+                }
+            }
+            else
+            {
+                line.swap(m_pending);
+                m_pending.clear();
+            }
+            if (!(m_format == "fcd" ? ParseFcd(line, end) : ParseNs2(line, end)))
+            {
+                m_pending.swap(line); // beyond this window, re-read next time
+                break;
+            }
+        }
+        if (m_format == "ns2")
+        {
+            // nothing before `end` can cut the legs any more (all of them at EOF)
+            for (uint32_t i = 0; i < m_state.size(); ++i)
+            {
+                AdvanceLeg(i, m_eof ? Time::Max() : end);
+            }
+        }
+    }
+
+    /// Value of attribute `name` in an XML element line, false if absent.
+    static bool Attribute(const std::string& line, const char* name, std::string& value)
+    {
+        std::string key = std::string(" ") + name + "=\"";
+        size_t a = line.find(key);
+        if (a == std::string::npos)
+        {
+            return false;
+        }
+        a += key.size();
+        size_t b = line.find('"', a);
+        if (b == std::string::npos)
+        {
+            return false;
+        }
+        value.assign(line, a, b - a);
+        return true;
+    }
+
+    /// Returns false if the line starts a timestep past `end`.
+    bool ParseFcd(const std::string& line, Time end)
+    {
+        std::string v;
+        if (line.find("<timestep") != std::string::npos)
+        {
+            NS_ABORT_MSG_IF(!Attribute(line, "time", v), "FCD timestep without time: " << line);
+            Time t = Seconds(std::strtod(v.c_str(), nullptr));
+            if (t > end)
+            {
+                return false;
+            }
+            m_time = t;
+            return true;
+        }
+        if (line.find("<vehicle") == std::string::npos)
+        {
+            return true;
+        }
+        std::string id;
+        std::string x;
+        std::string y;
+        if (!Attribute(line, "id", id) || !Attribute(line, "x", x) || !Attribute(line, "y", y))
+        {
+            return true;
+        }
+        auto it = m_ids.find(id);
+        uint32_t idx;
+        if (it == m_ids.end())
+        {
+            idx = static_cast<uint32_t>(m_ids.size());
+            m_ids.emplace(id, idx);
+        }
+        else
+        {
+            idx = it->second;
+        }
+        Add(idx, m_time, Vector(std::strtod(x.c_str(), nullptr), std::strtod(y.c_str(), nullptr), 0));
+        return true;
+    }
+
+    /// Returns false if the line is a timed command past `end`.
+    bool ParseNs2(const std::string& line, Time end)
+    {
+        size_t n = line.find("$node_(");
+        if (n == std::string::npos)
+        {
+            return true;
+        }
+        uint32_t idx = static_cast<uint32_t>(std::strtoul(line.c_str() + n + 7, nullptr, 10));
+        size_t at = line.find("$ns_ at ");
+        if (at == std::string::npos)
+        {
+            // initial position: $node_(i) set X_ 10.0
+            size_t set = line.find(" set ", n);
+            if (set == std::string::npos || idx >= m_state.size())
+            {
+                return true;
+            }
+            char axis = line[set + 5];
+            double value = std::strtod(line.c_str() + set + 8, nullptr);
+            State& s = m_state[idx];
+            if (axis == 'X')
+            {
+                s.last.x = value;
+            }
+            else if (axis == 'Y')
+            {
+                s.last.y = value;
+            }
+            else
+            {
+                return true;
+            }
+            if (!s.moving)
+            {
+                SetInitial(idx, s.last);
+            }
+            return true;
+        }
+        Time t = Seconds(std::strtod(line.c_str() + at + 8, nullptr));
+        if (t > end)
+        {
+            return false;
+        }
+        size_t sd = line.find("setdest", n);
+        if (sd == std::string::npos || idx >= m_state.size())
+        {
+            ++m_skipped;
+            return true;
+        }
+        char* p = nullptr;
+        double x = std::strtod(line.c_str() + sd + 7, &p);
+        double y = std::strtod(p, &p);
+        double speed = std::strtod(p, nullptr);
+        State& s = m_state[idx];
+        if (s.moving && t < s.lastTime)
+        {
+            ++m_skipped;
+            return true;
+        }
+        // cut the pending leg at t, then the new one starts where it got to
+        AdvanceLeg(idx, t);
+        s.leg = false;
+        Add(idx, t, s.last);
+        Vector dest(x, y, 0);
+        double dist = CalculateDistance(s.last, dest);
+        if (speed > 0 && dist > 0)
+        {
+            s.leg = true;
+            s.legTo = dest;
+            s.legArrive = t + Seconds(dist / speed);
+        }
+        return true;
+    }
+
+    /// Position on the pending leg of `s` at `t` (>= its last waypoint).
+    Vector LegPosition(const State& s, Time t) const
+    {
+        if (t >= s.legArrive)
+        {
+            return s.legTo;
+        }
+        const double f = (t - s.lastTime).GetSeconds() / (s.legArrive - s.lastTime).GetSeconds();
+        return Vector(s.last.x + f * (s.legTo.x - s.last.x),
+                      s.last.y + f * (s.legTo.y - s.last.y),
+                      s.last.z + f * (s.legTo.z - s.last.z));
+    }
+
+    /// Add the pending leg up to `t`: its arrival if it is reached by then,
+    /// otherwise the point reached at `t`, from which the leg continues.
+    void AdvanceLeg(uint32_t idx, Time t)
+    {
+        State& s = m_state[idx];
+        if (!s.leg)
+        {
+            return;
+        }
+        if (s.legArrive <= t)
+        {
+            s.leg = false;
+            Add(idx, s.legArrive, s.legTo);
+        }
+        else if (t > s.lastTime)
+        {
+            Add(idx, t, LegPosition(s, t));
+        }
+    }
+
+    /// ns-2 initial position, valid until the first waypoint is added.
+    void SetInitial(uint32_t idx, const Vector& pos)
+    {
+        State& s = m_state[idx];
+        s.seen = true;
+        s.first = pos;
+        s.last = pos;
+        m_models[idx]->SetPosition(pos);
+    }
+
+    void Add(uint32_t idx, Time t, const Vector& pos)
+    {
+        if (idx >= m_state.size())
+        {
+            ++m_skipped;
+            return;
+        }
+        State& s = m_state[idx];
+        if (s.moving && t < s.lastTime)
+        {
+            ++m_skipped;
+            return;
+        }
+        if (!s.seen)
+        {
+            // leave the parking spot just before the first sample
+            s.seen = true;
+            s.first = pos;
+            if (t.IsStrictlyPositive())
+            {
+                m_models[idx]->AddWaypoint(Waypoint(t - NanoSeconds(1), ParkedPosition(idx)));
+            }
+        }
+        if (s.moving && t == s.lastTime)
+        {
+            // same instant as the previous waypoint (setdest issued on arrival)
+            s.last = pos;
+            return;
+        }
+        m_models[idx]->AddWaypoint(Waypoint(t, pos));
+        s.moving = true;
+        s.last = pos;
+        s.lastTime = t;
+        ++m_waypoints;
+    }
+
+    std::string m_format;
+    Time m_window;
+    std::ifstream m_is;
+    std::string m_pending;
+    bool m_eof{false};
+    Time m_time;
+    std::unordered_map<std::string, uint32_t> m_ids;
+    std::vector<Ptr<WaypointMobilityModel>> m_models;
+    std::vector<State> m_state;
+    uint64_t m_waypoints{0};
+    uint64_t m_skipped{0};
+};
+
+} // namespace ns3
+
+#endif /* V2X_TRACE_MOBILITY_H */
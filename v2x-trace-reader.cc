@@ -0,0 +1,195 @@
+/* v2x-trace-reader.cc
+ *
+ * Converts the binary files written by the V2X scenario back to text.
+ * - V2XPHY01 (PHY trace): one ASCII-trace style line per record, or CSV
+ * - V2XEVT01 (event log): CSV
+ * - V2XCOL01 (columnar results): CSV, one block per table or just --table
+ *
+ * Run example:
+ *   ./ns3 run scratch/v2x-trace-reader.cc -- --in=v2x-sim-final-phy.bin --out=v2x-sim-final.tr
+ */
+
+#include "ns3/core-module.h"
+
+#include "v2x-columnar.h"
+#include "v2x-event-log.h"
+#include "v2x-phy-trace.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+template <typename Record, typename Writer>
+static uint64_t
+ConvertRecords(std::istream& is, uint32_t recordSize, Writer write)
+{
+    NS_ABORT_MSG_IF(recordSize != sizeof(Record),
+                    "Record size " << recordSize << " does not match this reader ("
+                                   << sizeof(Record) << ")");
+    // read in blocks, the same size the writer flushes
+    std::vector<Record> block(1 << 16);
+    uint64_t n = 0;
+    while (is)
+    {
+        is.read(reinterpret_cast<char*>(block.data()),
+                static_cast<std::streamsize>(block.size() * sizeof(Record)));
+        size_t got = static_cast<size_t>(is.gcount()) / sizeof(Record);
+        for (size_t i = 0; i < got; ++i)
+        {
+            write(block[i]);
+        }
+        n += got;
+    }
+    return n;
+}
+
+static uint64_t
+ConvertColumnar(const std::string& in, const std::string& only, std::ostream& os)
+{
+    V2xColumnarReader reader;
+    reader.Open(in);
+    uint64_t n = 0;
+    for (uint32_t t = 0; t < reader.GetHeader().nTables; ++t)
+    {
+        const v2xcol::TableEntry& table = reader.GetTable(t);
+        if (!only.empty() && only != table.name)
+        {
+            continue;
+        }
+        if (only.empty())
+        {
+            os << "# table " << table.name << '\n';
+        }
+        for (uint32_t c = 0; c < table.nColumns; ++c)
+        {
+            os << (c ? "," : "") << reader.GetColumn(t, c).name;
+        }
+        os << '\n';
+        for (uint64_t r = 0; r < table.nRows; ++r)
+        {
+            for (uint32_t c = 0; c < table.nColumns; ++c)
+            {
+                os << (c ? "," : "");
+                switch (reader.GetColumn(t, c).type)
+                {
+                case v2xcol::U32:
+                    os << reader.GetData<uint32_t>(t, c)[r];
+                    break;
+                case v2xcol::U64:
+                    os << reader.GetData<uint64_t>(t, c)[r];
+                    break;
+                case v2xcol::I64:
+                    os << reader.GetData<int64_t>(t, c)[r];
+                    break;
+                default:
+                    os << reader.GetData<double>(t, c)[r];
+                    break;
+                }
+            }
+            os << '\n';
+        }
+        n += table.nRows;
+    }
+    return n;
+}
+
+/// Seconds with all nine decimals, straight from the integer: going through
+/// a double (and the stream's default precision) loses ns on long runs.
+static void
+WriteSeconds(std::ostream& os, int64_t ns)
+{
+    const char* sign = ns < 0 ? "-" : "";
+    const uint64_t abs = ns < 0 ? uint64_t(0) - uint64_t(ns) : uint64_t(ns);
+    os << sign << abs / 1000000000 << '.' << std::setw(9) << std::setfill('0')
+       << abs % 1000000000 << std::setfill(' ');
+}
+
+static void
+WritePhyText(std::ostream& os, const V2xPhyTraceRecord& r)
+{
+    static const char codes[] = {'t', 'r', 'e'};
+    static const char* const states[] = {"Tx", "RxOk", "RxError"};
+    const uint32_t type = r.type < 3 ? r.type : 2;
+    os << codes[type] << ' ';
+    WriteSeconds(os, r.timeNs);
+    os << " /NodeList/" << r.node << "/DeviceList/"
+       << (r.flags >> 4) << "/$ns3::WifiNetDevice/Phy/State/" << states[type]
+       << " rate=" << r.rateKbps << "kbps seq=" << r.seq
+       << " retry=" << (r.flags & V2xPhyTrace::FLAG_RETRY) << " size=" << r.size << '\n';
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string in;
+    std::string out;
+    bool csv = false;
+    std::string table;
+
+    CommandLine cmd;
+    cmd.AddValue("in", "Binary trace or event log to convert", in);
+    cmd.AddValue("out", "Text output file (default: stdout)", out);
+    cmd.AddValue("csv", "PHY trace: CSV instead of ASCII-trace style lines", csv);
+    cmd.AddValue("table", "Columnar results: only this table (flows|nodes)", table);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(in.empty(), "--in is required");
+    std::ifstream is(in, std::ios::in | std::ios::binary);
+    NS_ABORT_MSG_IF(!is.is_open(), "Cannot open " << in);
+
+    char magic[8];
+    uint32_t recordSize = 0;
+    is.read(magic, sizeof(magic));
+    is.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));
+    NS_ABORT_MSG_IF(!is, in << " is too short for a V2X binary header");
+
+    std::ofstream file;
+    if (!out.empty())
+    {
+        file.open(out);
+        NS_ABORT_MSG_IF(!file.is_open(), "Cannot open " << out);
+    }
+    std::ostream& os = out.empty() ? std::cout : file;
+
+    uint64_t n = 0;
+    if (std::memcmp(magic, "V2XPHY01", 8) == 0)
+    {
+        if (csv)
+        {
+            V2xPhyTraceRecord::WriteCsvHeader(os);
+        }
+        auto write = [&os, csv](const V2xPhyTraceRecord& r) {
+            if (csv)
+            {
+                r.WriteCsv(os);
+            }
+            else
+            {
+                WritePhyText(os, r);
+            }
+        };
+        n = ConvertRecords<V2xPhyTraceRecord>(is, recordSize, write);
+    }
+    else if (std::memcmp(magic, "V2XCOL01", 8) == 0)
+    {
+        n = ConvertColumnar(in, table, os);
+    }
+    else if (std::memcmp(magic, "V2XEVT01", 8) == 0)
+    {
+        V2xEventRecord::WriteCsvHeader(os);
+        n = ConvertRecords<V2xEventRecord>(is, recordSize, [&os](const V2xEventRecord& r) {
+            r.WriteCsv(os);
+        });
+    }
+    else
+    {
+        NS_FATAL_ERROR(in << " is not a V2X binary trace (unknown magic)");
+    }
+
+    std::cerr << "Converted " << n << " records from " << in << "\n";
+    return 0;
+}
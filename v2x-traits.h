@@ -0,0 +1,62 @@
+/* v2x-traits.h
+ *
+ * Compile-time scenario profile: which instrumentation exists at all.
+ * - A traits struct holds one constexpr bool per per-event subsystem: the
+ *   event log, stamped metrics, per-packet queue events, the binary PHY
+ *   trace and hot-callback timing
+ * - The hot callbacks in V2X-Main.cc are templates on the traits and test
+ *   them with `if constexpr`, so a disabled subsystem leaves no branch,
+ *   load or call in the instantiated callback; enabled subsystems keep
+ *   their runtime switches (--logLevel, --metrics, ...)
+ * - ScenarioConfig takes its defaults from the selected traits, and a run
+ *   that asks for a compiled-out subsystem stops at setup
+ *
+ * Selected at build time: -DV2X_THROUGHPUT_BUILD picks
+ * V2xThroughputTraits, -DV2X_SCENARIO_TRAITS=<type> any other profile;
+ * the default is V2xFullTraits (everything available, as before).
+ * PCAP, ASCII, FlowMonitor and queue statistics cost nothing per event
+ * unless installed, so they stay runtime options in every profile.
+ */
+
+#ifndef V2X_TRAITS_H
+#define V2X_TRAITS_H
+
+namespace ns3
+{
+
+/// Everything compiled in; the runtime options decide (debug / analysis).
+struct V2xFullTraits
+{
+    static constexpr const char* NAME = "full";
+    static constexpr bool EVENT_LOG = true;       //!< V2xEventLog records in callbacks
+    static constexpr bool METRICS = true;         //!< stamp headers, PDR/latency/AoI
+    static constexpr bool QUEUE_EVENTS = true;    //!< per-packet qdisc records (logLevel 2)
+    static constexpr bool PHY_TRACE = true;       //!< binary PHY trace sinks
+    static constexpr bool CALLBACK_TIMING = true; //!< ReceivePacket budget in --realtime
+};
+
+/// Counters only: production throughput runs.
+struct V2xThroughputTraits
+{
+    static constexpr const char* NAME = "throughput";
+    static constexpr bool EVENT_LOG = false;
+    static constexpr bool METRICS = false;
+    static constexpr bool QUEUE_EVENTS = false;
+    static constexpr bool PHY_TRACE = false;
+    static constexpr bool CALLBACK_TIMING = false;
+};
+
+#ifndef V2X_SCENARIO_TRAITS
+#ifdef V2X_THROUGHPUT_BUILD
+#define V2X_SCENARIO_TRAITS V2xThroughputTraits
+#else
+#define V2X_SCENARIO_TRAITS V2xFullTraits
+#endif
+#endif
+
+/// The profile this build was compiled with.
+typedef V2X_SCENARIO_TRAITS V2xScenarioTraits;
+
+} // namespace ns3
+
+#endif /* V2X_TRAITS_H */
@@ -0,0 +1,130 @@
+/* v2x-vehicle-table.h
+ *
+ * Per-vehicle scenario state in one structure-of-arrays table.
+ * - One row per local vehicle, in vehicle order: global vehicle index
+ *   (metrics slot), data channel, current RSU and DATA destination, socket
+ *   and client application
+ * - All columns are sized once in Init() (a single allocation each,
+ *   whatever the vehicle count), instead of per-vehicle objects and
+ *   vectors scattered over lambda captures
+ * - The DATA destination is cached per row and only rewritten on handover,
+ *   so a send reads one address instead of looking up RSU and channel
+ *
+ * The table is shared by Ptr between the send, handover and DCC callbacks.
+ */
+
+#ifndef V2X_VEHICLE_TABLE_H
+#define V2X_VEHICLE_TABLE_H
+
+#include "ns3/abort.h"
+#include "ns3/application.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/socket.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+class V2xVehicleTable : public SimpleRefCount<V2xVehicleTable>
+{
+  public:
+    /// One row per entry of `globalIndex` (global index of each local vehicle).
+    void Init(std::vector<uint32_t> globalIndex)
+    {
+        const size_t n = globalIndex.size();
+        m_globalIndex = std::move(globalIndex);
+        m_dataChannel.assign(n, 0);
+        m_rsu.assign(n, 0);
+        m_destination.assign(n, Ipv4Address());
+        m_socket.assign(n, nullptr);
+        m_client.assign(n, nullptr);
+    }
+
+    uint32_t GetN() const
+    {
+        return static_cast<uint32_t>(m_globalIndex.size());
+    }
+
+    uint32_t GetGlobalIndex(uint32_t i) const
+    {
+        return m_globalIndex[i];
+    }
+
+    const std::vector<uint32_t>& GetGlobalIndices() const
+    {
+        return m_globalIndex;
+    }
+
+    uint32_t GetDataChannel(uint32_t i) const
+    {
+        return m_dataChannel[i];
+    }
+
+    void SetDataChannel(uint32_t i, uint32_t channel)
+    {
+        m_dataChannel[i] = channel;
+    }
+
+    /**
+     * RSU DATA addresses per channel: rsuDataIps[channel][rsu]. Held by
+     * reference; must outlive the table's users.
+     */
+    void SetRsuAddresses(const std::vector<std::vector<Ipv4Address>>* rsuDataIps)
+    {
+        m_rsuDataIps = rsuDataIps;
+    }
+
+    /// Point vehicle `i`'s DATA at RSU `rsu` on its data channel.
+    void SetRsu(uint32_t i, uint32_t rsu)
+    {
+        NS_ABORT_MSG_IF(!m_rsuDataIps, "V2xVehicleTable: RSU addresses not set");
+        m_rsu[i] = rsu;
+        m_destination[i] = (*m_rsuDataIps)[m_dataChannel[i]][rsu];
+    }
+
+    uint32_t GetRsu(uint32_t i) const
+    {
+        return m_rsu[i];
+    }
+
+    Ipv4Address GetDestination(uint32_t i) const
+    {
+        return m_destination[i];
+    }
+
+    Ptr<Socket> GetSocket(uint32_t i) const
+    {
+        return m_socket[i];
+    }
+
+    void SetSocket(uint32_t i, Ptr<Socket> socket)
+    {
+        m_socket[i] = socket;
+    }
+
+    Ptr<Application> GetClient(uint32_t i) const
+    {
+        return m_client[i];
+    }
+
+    void SetClient(uint32_t i, Ptr<Application> client)
+    {
+        m_client[i] = client;
+    }
+
+  private:
+    std::vector<uint32_t> m_globalIndex;
+    std::vector<uint32_t> m_dataChannel;
+    std::vector<uint32_t> m_rsu;
+    std::vector<Ipv4Address> m_destination;
+    std::vector<Ptr<Socket>> m_socket;
+    std::vector<Ptr<Application>> m_client;
+    const std::vector<std::vector<Ipv4Address>>* m_rsuDataIps{nullptr};
+};
+
+} // namespace ns3
+
+#endif /* V2X_VEHICLE_TABLE_H */